@@ -5,6 +5,7 @@
 
 
 struct CustomMapDef;
+struct GameModule;
 
 typedef void (*SendCustomCommandToClientFunc_t)(int id, int size, void * data);
 typedef void (*SetSpectateFunc_t)(int localPlayerIndex, int spectatePlayerOrDisable);
@@ -14,6 +15,8 @@ typedef int (*ReadCustomMapExtraDataFunc_t)(char* mapFilename, void* buffer, int
 typedef void (*RefreshCustomMapDefsFunc_t)(void);
 typedef void (*HopToCustomMapFunc_t)(struct CustomMapDef* def);
 typedef int (*ReadExtraData_f)(void* dst, int len);
+typedef void (*ModuleEventHandler_f)(struct GameModule * module, int event, void * arg);
+typedef int (*ModuleEventSubscribeFunc_t)(struct GameModule * module, unsigned int eventMask, ModuleEventHandler_f handler);
 
 
 // General Tab
@@ -130,6 +133,7 @@ typedef struct PatchPointers {
   char ServerTimeHour;
   char ServerTimeMinute;
   char ServerTimeSecond;
+  ModuleEventSubscribeFunc_t ModuleEventSubscribe;
 } PatchPointers_t;
 
 typedef struct CustomMapDef {
@@ -96,6 +96,65 @@ typedef struct GameModule
 
 } GameModule;
 
+/*
+ * NAME :		ModuleEvent
+ * DESCRIPTION :
+ * 			Events the patcher publishes to game modules.
+ * NOTES :
+ *          Modules subscribe with PATCH_POINTERS->ModuleEventSubscribe and
+ *          a mask of MODULE_EVENT_MASK bits. Handlers are only invoked
+ *          while the module is not 'OFF'.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+typedef enum ModuleEvent
+{
+    /*
+     * Moved between menus, loading and game. Arg is the new ModuleScene.
+     */
+    MODULE_EVENT_SCENE_CHANGE,
+
+    /*
+     * Gameplay data was read from the disc. Arg is the GameplayHeaderDef_t.
+     */
+    MODULE_EVENT_GAMEPLAY_LOADED,
+
+    /*
+     * First frame of a game. Arg is NULL.
+     */
+    MODULE_EVENT_GAME_START,
+
+    /*
+     * The game has ended. Arg is NULL.
+     */
+    MODULE_EVENT_GAME_END,
+
+    /*
+     * A player respawned. Arg is the Player.
+     */
+    MODULE_EVENT_PLAYER_SPAWN,
+
+    /*
+     * A player died. Arg is the Player.
+     */
+    MODULE_EVENT_PLAYER_DEATH,
+
+    /*
+     * A player changed team. Arg is the Player.
+     */
+    MODULE_EVENT_PLAYER_TEAM_CHANGE,
+
+    MODULE_EVENT_COUNT
+} ModuleEvent;
+
+#define MODULE_EVENT_MASK(event)                (1 << (event))
+
+typedef enum ModuleScene
+{
+    MODULE_SCENE_LOADING,
+    MODULE_SCENE_MENUS,
+    MODULE_SCENE_GAME
+} ModuleScene;
+
 typedef struct UpdateGameStateRequest {
 	char TeamsEnabled;
     char PADDING;
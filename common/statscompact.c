@@ -0,0 +1,154 @@
+/***************************************************
+ * FILENAME :		statscompact.c
+ * DESCRIPTION :
+ * 		Compact encoding for CustomGameModeStats_t uploads.
+ *    Decoded by misc/statsdecode.c and tested by misc/statstest.c,
+ *    so this file must not depend on libuya.
+ */
+
+#include "statscompact.h"
+
+//--------------------------------------------------------------------------
+// compact stats encoding
+//
+// header : u8 version, varint size in bytes
+// body   : tokens over the payload as 32 bit words, last word zero padded
+//   varint (n << 2) | 0 : n zero words
+//   varint (n << 2) | 1 : n literal words follow, each a zigzag varint
+//   varint (n << 2) | 2 : varint distance, copy n words from that many words back
+//
+// when the tokens wouldn't be smaller the version has STATS_COMPACT_STORED
+// set and the body is the payload as is
+//--------------------------------------------------------------------------
+int statsCompactPutVarint(u8* dst, int pos, int dstSize, u32 value)
+{
+	do {
+		if (pos >= dstSize)
+			return -1;
+
+		u8 b = value & 0x7F;
+		value >>= 7;
+		dst[pos++] = b | (value ? 0x80 : 0);
+	} while (value);
+
+	return pos;
+}
+
+u32 statsCompactGetWord(u8* src, int size, int word)
+{
+	u32 value = 0;
+	int i;
+
+	for (i = 3; i >= 0; --i) {
+		int idx = (word * 4) + i;
+		value = (value << 8) | (idx < size ? src[idx] : 0);
+	}
+
+	return value;
+}
+
+int statsCompactFindRepeat(u8* src, int size, int wordCount, int word, int* distance)
+{
+	int bestLen = 0, j;
+	int start = word > STATS_COMPACT_WINDOW ? word - STATS_COMPACT_WINDOW : 0;
+
+	for (j = start; j < word; ++j) {
+		int len = 0;
+		while ((word + len) < wordCount && statsCompactGetWord(src, size, j + len) == statsCompactGetWord(src, size, word + len))
+			++len;
+
+		if (len > bestLen) {
+			bestLen = len;
+			*distance = word - j;
+		}
+	}
+
+	return bestLen;
+}
+
+int statsCompactEncodeStored(u8* src, int size, u8* dst, int dstSize)
+{
+	int pos = 0, i;
+
+	if (dstSize < 1)
+		return -1;
+
+	dst[pos++] = STATS_COMPACT_VERSION | STATS_COMPACT_STORED;
+	pos = statsCompactPutVarint(dst, pos, dstSize, size);
+	if (pos < 0 || size > (dstSize - pos))
+		return -1;
+
+	for (i = 0; i < size; ++i)
+		dst[pos++] = src[i];
+
+	return pos;
+}
+
+int statsCompactEncodeTokens(void* src, int size, u8* dst, int dstSize)
+{
+	u8* bytes = (u8*)src;
+	int wordCount = (size + 3) / 4;
+	int pos = 0, i = 0, j;
+	int dist = 0;
+
+	if (dstSize < 1)
+		return -1;
+
+	dst[pos++] = STATS_COMPACT_VERSION;
+	pos = statsCompactPutVarint(dst, pos, dstSize, size);
+
+	while (i < wordCount && pos >= 0) {
+
+		// zero run
+		if (statsCompactGetWord(bytes, size, i) == 0) {
+			int n = 1;
+			while ((i + n) < wordCount && statsCompactGetWord(bytes, size, i + n) == 0)
+				++n;
+
+			pos = statsCompactPutVarint(dst, pos, dstSize, (n << 2) | 0);
+			i += n;
+			continue;
+		}
+
+		// repeat of earlier words
+		int len = statsCompactFindRepeat(bytes, size, wordCount, i, &dist);
+		if (len >= 2) {
+			pos = statsCompactPutVarint(dst, pos, dstSize, (len << 2) | 2);
+			if (pos >= 0)
+				pos = statsCompactPutVarint(dst, pos, dstSize, dist);
+			i += len;
+			continue;
+		}
+
+		// literals until a zero or a repeat
+		int n = 1;
+		while ((i + n) < wordCount && statsCompactGetWord(bytes, size, i + n) != 0 && statsCompactFindRepeat(bytes, size, wordCount, i + n, &dist) < 2)
+			++n;
+
+		pos = statsCompactPutVarint(dst, pos, dstSize, (n << 2) | 1);
+		for (j = 0; j < n && pos >= 0; ++j) {
+			int value = (int)statsCompactGetWord(bytes, size, i + j);
+			pos = statsCompactPutVarint(dst, pos, dstSize, ((u32)value << 1) ^ (u32)(value >> 31));
+		}
+		i += n;
+	}
+
+	return pos;
+}
+
+int statsCompactEncode(void* src, int size, u8* dst, int dstSize)
+{
+	u8 header[8];
+	int storedSize, pos;
+
+	if (size < 0)
+		return -1;
+
+	// tokens only win if they fit in less than the stored form
+	storedSize = statsCompactPutVarint(header, 1, sizeof(header), size) + size;
+	pos = statsCompactEncodeTokens(src, size, dst, dstSize < storedSize ? dstSize : storedSize - 1);
+	if (pos >= 0)
+		return pos;
+
+	return statsCompactEncodeStored((u8*)src, size, dst, dstSize);
+}
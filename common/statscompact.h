@@ -0,0 +1,20 @@
+#ifndef _PATCH_STATSCOMPACT_
+#define _PATCH_STATSCOMPACT_
+
+// host tools (misc/statsdecode.c, misc/statstest.c) build without the ps2sdk
+#ifdef STATS_COMPACT_HOST
+#include <stdint.h>
+typedef uint8_t u8;
+typedef uint32_t u32;
+#else
+#include <tamtypes.h>
+#endif
+
+// compact encoding for CustomGameModeStats_t uploads, decoded by misc/statsdecode.c
+#define STATS_COMPACT_VERSION       (1)
+#define STATS_COMPACT_STORED        (0x80) // or'd into the version, raw bytes follow the size
+#define STATS_COMPACT_WINDOW        (64) // words searched back for repeats
+
+int statsCompactEncode(void* src, int size, u8* dst, int dstSize);
+
+#endif // _PATCH_STATSCOMPACT_
@@ -307,25 +307,23 @@ void processPlayer(Player * player)
  */
 Player * getRandomSurvivor(u32 seed)
 {
-	Player ** playerObjects = playerGetAll();
+	PlayerRoster_t * roster = playerGetRoster();
 
-	int value = (seed % GAME_MAX_PLAYERS) + 1;
+	int value = (seed % GAME_MAX_PLAYERS);
 	int i = 0;
-	int counter = 0;
+	int count = 0;
+	Player * survivors[GAME_MAX_PLAYERS];
 
-	while (counter < value) {
-		for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
-			if (playerObjects[i] && !isInfected(playerObjects[i]->mpIndex)) {
-				++counter;
-				if (value == counter)
-					return playerObjects[i];
-			}
-		}
-		// This means that there are no survivors left
-		if (counter == 0)
-			return NULL;
+	for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
+		if ((roster->PresentMask & (1 << i)) && !isInfected(roster->Players[i]->mpIndex))
+			survivors[count++] = roster->Players[i];
 	}
-	return NULL;
+
+	// This means that there are no survivors left
+	if (count == 0)
+		return NULL;
+
+	return survivors[value % count];
 }
 
 /*
@@ -58,6 +58,7 @@
 #define KOTH_HILL_ACTIVE_MS    (TIME_SECOND * 60)
 #define KOTH_NAME_MAX_LEN      (7)
 #define KOTH_OCLASS_CUSTOM     (0x3000) // custom hill moby oclass
+#define KOTH_OCLASS_DRAW       (0x1c0d) // moby used to register the hill draw callback
 #define KOTH_MAX_CUSTOM_CUBOIDS (32)
 
 #ifndef KOTH_RING_WALL_FX
@@ -117,6 +118,8 @@ typedef struct KothHudCache {
 } KothHudCache_t;
 
 static KothHill_t hills[KOTH_MAX_HILLS];
+static MobyPool_t hillDrawPool;
+static Moby *hillDrawPoolMobies[KOTH_MAX_HILLS];
 static int hillCount = 0;
 static int initialized = 0;
 static int gameEndHookInstalled = 0;
@@ -126,6 +129,7 @@ static int nextScoreTickTime = 0;
 static int gameOverTriggered = 0;
 static int hillCycleStartTime = 0;
 static int lastTimeStart = -1;
+static int respawnWaiting = 0; // a local player died and hasn't respawned yet
 #if KOTH_ENABLE_HILL_SYNC
 static int lastActiveHillIdx = -1;
 #endif
@@ -904,9 +908,7 @@ static void kothGetHillYaw(const KothHill_t *hill, float *cosYaw, float *sinYaw)
         float x = hill->axisX[0];
         float y = hill->axisX[1];
         if (x != 0.0f || y != 0.0f) {
-            float ang = atan2f(y, x);
-            c = cosf(ang);
-            s = sinf(ang);
+            fastSincosf(fastAtan2f(y, x), &s, &c);
         }
     }
     if (cosYaw) *cosYaw = c;
@@ -1108,9 +1110,8 @@ static void scanHillsOnce(void)
                     kothComputeHillAxes(&hills[hillCount]);
                     hills[hillCount].scroll = 0;
                     hills[hillCount].drawAtMidpoint = 0;
-                    hills[hillCount].drawMoby = mobySpawn(0x1c0d, 0);
+                    hills[hillCount].drawMoby = mobyPoolAcquire(&hillDrawPool, hills[hillCount].position);
                     if (hills[hillCount].drawMoby) {
-                        vector_copy(hills[hillCount].drawMoby->position, hills[hillCount].position);
                         hills[hillCount].drawMoby->updateDist = -1;
                         hills[hillCount].drawMoby->drawn = 1;
                     hills[hillCount].drawMoby->alpha = 0;
@@ -1129,11 +1130,12 @@ static void scanHillsOnce(void)
         }
     }
 
-    Moby* moby = mobyListGetStart();
-    Moby* mobyEnd = mobyListGetEnd();
+    MobyClassIterator_t it;
+    Moby* moby;
     int foundCustom = 0;
     if (source != 3) {
-    while (moby < mobyEnd && hillCount < KOTH_MAX_HILLS) {
+    moby = mobyClassIterBegin(&it, KOTH_OCLASS_CUSTOM);
+    while (moby && hillCount < KOTH_MAX_HILLS) {
         if (moby->oClass == KOTH_OCLASS_CUSTOM) {
             // One custom hill moby defines multiple cuboids; emit a hill per valid cuboid. (OCLASS 3000) 
 //TODO we may want to scale the hill based off of the cuboid size (and other transformations?) 
@@ -1179,9 +1181,8 @@ static void scanHillsOnce(void)
                     hills[hillCount].drawAtMidpoint = 0;
                     if (hills[hillCount].radiusX <= 0) hills[hillCount].radiusX = KOTH_RING_RADIUS;
                     if (hills[hillCount].radiusY <= 0) hills[hillCount].radiusY = KOTH_RING_RADIUS;
-                    hills[hillCount].drawMoby = mobySpawn(0x1c0d, 0);
+                    hills[hillCount].drawMoby = mobyPoolAcquire(&hillDrawPool, hills[hillCount].position);
                     if (hills[hillCount].drawMoby) {
-                        vector_copy(hills[hillCount].drawMoby->position, hills[hillCount].position);
                         hills[hillCount].drawMoby->updateDist = -1;
                         hills[hillCount].drawMoby->drawn = 1;
                         hills[hillCount].drawMoby->alpha = 0;
@@ -1201,15 +1202,14 @@ static void scanHillsOnce(void)
                 }
             }
         }
-        ++moby;
+        moby = mobyClassIterNext(&it);
     }
     }
 
     // If no custom hills found, fall back to siege nodes.
     if (source != 3 && !foundCustom) {
-        moby = mobyListGetStart();
-        mobyEnd = mobyListGetEnd();
-        while (moby < mobyEnd && hillCount < KOTH_MAX_HILLS) {
+        moby = mobyClassIterBegin(&it, MOBY_ID_SIEGE_NODE);
+        while (moby && hillCount < KOTH_MAX_HILLS) {
             if (moby->oClass == MOBY_ID_SIEGE_NODE) {
 #if KOTH_SIEGE_USE_BOLT_CRANK
                 // Prefer the bolt crank attached to this node (pVar + 0x3c) for positioning.
@@ -1261,9 +1261,8 @@ static void scanHillsOnce(void)
 #endif
                 hills[hillCount].moby = moby;
                 hills[hillCount].scroll = 0;
-                hills[hillCount].drawMoby = mobySpawn(0x1c0d, 0);
+                hills[hillCount].drawMoby = mobyPoolAcquire(&hillDrawPool, hills[hillCount].position);
                 if (hills[hillCount].drawMoby) {
-                    vector_copy(hills[hillCount].drawMoby->position, hills[hillCount].position);
                     hills[hillCount].drawMoby->updateDist = -1;
                     hills[hillCount].drawMoby->drawn = 1;
                     hills[hillCount].drawMoby->alpha = 0;
@@ -1286,7 +1285,7 @@ static void scanHillsOnce(void)
 #endif
                 ++hillCount;
             }
-            ++moby;
+            moby = mobyClassIterNext(&it);
         }
     }
     if (source == 0) {
@@ -2108,8 +2107,8 @@ static void drawHillAt(const KothHill_t *hill, VECTOR center, u32 color, float *
     if (isCircle) {
         // Quad-per-segment along the arc (manual rotation instead of Rodrigues).
         vector_copy(vRadius, halfX);
-        float cosStep = cosf(thetaStep);
-        float sinStep = sinf(thetaStep);
+        float cosStep, sinStep;
+        fastSincosf(thetaStep, &sinStep, &cosStep);
         QuadDef quad;
         gfxSetupEffectTex(&quad, kothRingWallFx, 0, 0x80);
         // u = 0 at current angle, u = 1 at next; v scrolls vertically.
@@ -2369,6 +2368,10 @@ void scoreboard(int maxScore, int* scores)
     // Flush state once before HUD drawing to reduce GS/GIF bleed risk.
     gfxDoGifPaging();
     char buf[32];
+    float iconX, iconY, iconScale;
+
+    // record boxes and text so they are drawn grouped by type instead of interleaved per row
+    gfxBatchBegin();
 
     {
         float rowYnorm = anchorY;
@@ -2377,23 +2380,19 @@ void scoreboard(int maxScore, int* scores)
         float slotY = rowYnorm * SCREEN_HEIGHT;
         float slotW = width * SCREEN_WIDTH;
         float slotH = height * SCREEN_HEIGHT;
-        float iconScale = slotH * 0.6f;
         float iconGap = 4.0f;
         int textWidth = kothHudCache.timerTextWidth;
+        iconScale = slotH * 0.6f;
         float groupWidth = iconScale + iconGap + textWidth;
         float groupX = slotX + (slotW - groupWidth) * 0.5f;
-        float iconX = groupX;
-        float iconY = slotY + (slotH - iconScale) * 0.5f;
+        iconX = groupX;
+        iconY = slotY + (slotH - iconScale) * 0.5f;
         float timerTextX = iconX + iconScale + iconGap;
 
         gfxScreenSpaceBox(anchorX, rowYnorm, width, height, (opacity << 24) | bgColor);
-        gfxDrawHUDIcon(KOTH_TIMER_ICON_SPRITE, iconX, iconY, iconScale, (opacity << 24) | textColor);
         gfxScreenSpaceText(timerTextX, textYnorm * SCREEN_HEIGHT, 1.0f, 1.0f, (opacity << 24) | textColor, kothHudCache.timerBuf, -1, TEXT_ALIGN_MIDDLELEFT, FONT_BOLD);
     }
 
-    if (kothHudCache.numRows <= 0)
-        return;
-
     int i;
     for (i = 0; i < kothHudCache.numRows; ++i) {
         int currentScore = kothHudCache.rows[i].score;
@@ -2435,6 +2434,10 @@ void scoreboard(int maxScore, int* scores)
 
     }
 
+    gfxBatchEnd();
+
+    // sprite isn't batched, draw it over the timer box
+    gfxDrawHUDIcon(KOTH_TIMER_ICON_SPRITE, iconX, iconY, iconScale, (opacity << 24) | textColor);
 }
 
 static void drawHud(void)
@@ -2491,16 +2494,16 @@ static int kothOnReceiveHillSync(void *connection, void *data)
 }
 #endif
 
+void kothModeInit(void)
+{
+    // Once per match, before the first kothReset. The previous level's mobies are already gone.
+    mobyPoolInit(&hillDrawPool, hillDrawPoolMobies, KOTH_MAX_HILLS, KOTH_OCLASS_DRAW, 0);
+}
+
 void kothReset(void)
 {
-    // Clean up any spawned draw mobies to clear registered draw callbacks.
-    int i;
-    for (i = 0; i < hillCount; ++i) {
-        if (hills[i].drawMoby) {
-            mobyDestroy(hills[i].drawMoby);
-            hills[i].drawMoby = NULL;
-        }
-    }
+    // Hide draw mobies to clear registered draw callbacks; they're reused by the next scan.
+    mobyPoolReleaseAll(&hillDrawPool);
 
     initialized = 0;
     handlerInstalled = 0;
@@ -2511,6 +2514,7 @@ void kothReset(void)
     gameEndHandled = 0;
     hillCycleStartTime = 0;
     lastTimeStart = -1;
+    respawnWaiting = 0;
 #if KOTH_ENABLE_HILL_SYNC
     lastActiveHillIdx = -1;
 #endif
@@ -2724,21 +2728,35 @@ static void kothUpdateRespawnDistance(Player *player)
 
 static void kothUpdateRespawnDistanceForLocals(void)
 {
-    if (!kothRespawnDistanceIsCustom())
+    // Only between a local death (kothOnPlayerDeath) and the respawn.
+    if (!respawnWaiting || !kothRespawnDistanceIsCustom())
         return;
 
     Player **players = playerGetAll();
     int i;
+    respawnWaiting = 0;
     for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
         Player *p = players[i];
         if (!p || !p->isLocal)
             continue;
+        if (playerIsDead(p))
+            respawnWaiting = 1;
         if (!p->timers.resurrectWait)
             continue;
         kothUpdateRespawnDistance(p);
     }
 }
 
+void kothOnPlayerDeath(Player *player)
+{
+    if (!player || !player->isLocal || !kothRespawnDistanceIsCustom())
+        return;
+
+    // Hill occupancy can change while waiting, so keep updating until the respawn.
+    respawnWaiting = 1;
+    kothUpdateRespawnDistance(player);
+}
+
 static u32 kothGetActiveHillColor(void)
 {
     // Default white; tint/blend to the colors of anyone occupying the hill.
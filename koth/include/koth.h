@@ -2,11 +2,14 @@
 #define KOTH_H
 
 #include <tamtypes.h>
+#include <libuya/player.h>
 #include "module.h"
 
 void kothSetConfig(PatchGameConfig_t *config);
 void kothSetUserConfig(PatchConfig_t *config);
+void kothModeInit(void);
 void kothReset(void);
 void kothTick(void);
+void kothOnPlayerDeath(Player *player);
 
 #endif // KOTH_H
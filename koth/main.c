@@ -26,6 +26,7 @@ struct KothState {
     int GameOver;
     int IsHost;
     int LastConfigSeed;
+    PatchGameConfig_t *GameConfig;
 };
 
 static struct KothState State;
@@ -33,12 +34,61 @@ int isCustomMap = 0;
 
 static void setLobbyGameOptions(PatchStateContainer_t *gameState);
 
+//--------------------------------------------------------------------------
+static void kothMatchStart(void)
+{
+    State.Initialized = 1;
+    State.GameOver = 0;
+    isCustomMap = State.GameConfig ? State.GameConfig->isCustomMap : 0;
+    kothModeInit();
+    kothReset();
+    // Reapply config after reset so size/seed stick on first init.
+    kothSetConfig(State.GameConfig);
+}
+
+//--------------------------------------------------------------------------
+static void onModuleEvent(struct GameModule * module, int event, void * arg)
+{
+    switch (event)
+    {
+        case MODULE_EVENT_GAME_START:
+        {
+            kothMatchStart();
+            break;
+        }
+        case MODULE_EVENT_GAME_END:
+        {
+            State.GameOver = 1;
+            break;
+        }
+        case MODULE_EVENT_PLAYER_DEATH:
+        {
+            if (State.Initialized)
+                kothOnPlayerDeath((Player*)arg);
+            break;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+static void subscribeModuleEvents(struct GameModule * module, PatchGameConfig_t * gameConfig)
+{
+    State.GameConfig = gameConfig;
+
+    // Subscribing again with the same mask is a no-op, and the patch drops us whenever the module is turned off.
+    if (PATCH_POINTERS && PATCH_POINTERS->ModuleEventSubscribe)
+        PATCH_POINTERS->ModuleEventSubscribe(module,
+            MODULE_EVENT_MASK(MODULE_EVENT_GAME_START) | MODULE_EVENT_MASK(MODULE_EVENT_GAME_END) | MODULE_EVENT_MASK(MODULE_EVENT_PLAYER_DEATH),
+            &onModuleEvent);
+}
+
 //--------------------------------------------------------------------------
 void gameStart(struct GameModule * module, PatchConfig_t * config, PatchGameConfig_t * gameConfig, PatchStateContainer_t *gameState)
 {
     GameSettings * gameSettings = gameGetSettings();
 
     uyaPreUpdate();
+    subscribeModuleEvents(module, gameConfig);
 
     // Ensure in game
     if (!gameSettings || !isInGame()) {
@@ -65,13 +115,9 @@ void gameStart(struct GameModule * module, PatchConfig_t * config, PatchGameConf
         }
     }
 
-    // initialize
+    // MODULE_EVENT_GAME_START initializes, unless the module was turned on too late to see it
     if (!State.Initialized) {
-        State.Initialized = 1;
-        isCustomMap = gameConfig ? gameConfig->isCustomMap : 0;
-        kothReset();
-        // Reapply config after reset so size/seed stick on first init.
-        kothSetConfig(gameConfig);
+        kothMatchStart();
         return;
     }
 
@@ -89,6 +135,8 @@ void lobbyStart(struct GameModule * module, PatchConfig_t * config, PatchGameCon
 {
     UiMenu_t *menu;
 
+    subscribeModuleEvents(module, gameConfig);
+
     // Lobby
     if (menu = uiGetActiveMenu(UI_MENU_STAGING, 0), menu != NULL) {
         // Ensure KOTH state is clean when entering staging for a new match.
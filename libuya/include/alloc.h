@@ -0,0 +1,246 @@
+/***************************************************
+ * FILENAME :		alloc.h
+ * DESCRIPTION :
+ * 		Tagged heap allocations, fixed size pools and arenas
+ *      on top of the game's malloc, with per tag usage stats.
+ * NOTES :
+ *      Each tagged allocation carries a 16 byte header so
+ *      allocations keep the alignment malloc gives them.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+
+#ifndef _LIBUYA_ALLOC_H_
+#define _LIBUYA_ALLOC_H_
+
+// host tools (misc/alloctest.c) build alloc.c without the ps2sdk
+#ifdef ALLOC_HOST
+#include <stdint.h>
+typedef uint8_t u8;
+typedef uint32_t u32;
+#else
+#include <tamtypes.h>
+#endif
+
+#define ALLOC_POISON_BYTE                   (0xDD)
+
+enum AllocTag
+{
+    ALLOC_TAG_DEFAULT = 0,
+    ALLOC_TAG_PATCH,
+    ALLOC_TAG_PLAYERSYNC,
+    ALLOC_TAG_MAPLOADER,
+    ALLOC_TAG_NET,
+    ALLOC_TAG_GAMEMODE,
+    ALLOC_TAG_COUNT
+};
+
+typedef struct AllocTagStats
+{
+    int Current;
+    int Peak;
+    int Allocs;
+    int Frees;
+    int Failed;
+} AllocTagStats_t;
+
+// fixed size blocks carved out of one tagged allocation
+typedef struct AllocPool
+{
+    u8 * Buffer;
+    void * FreeList;
+    int BlockSize;
+    int BlockCount;
+    int Used;
+    int Peak;
+    int Failed;
+} AllocPool_t;
+
+// bump allocator, freed all at once
+// may also be statically initialized over a static Buffer, see frameArenaAlloc
+typedef struct AllocArena
+{
+    u8 * Buffer;
+    int Size;
+    int Offset;
+    int Peak;
+    int Failed;
+} AllocArena_t;
+
+/*
+ * NAME :		allocTagged
+ * DESCRIPTION :
+ * 			Allocates size bytes from the heap and charges them to tag.
+ * NOTES :
+ *          Must be freed with freeTagged.
+ * ARGS :
+ *          tag   :           AllocTag to charge.
+ *          size  :           Number of bytes to allocate.
+ * RETURN :
+ *          Pointer to the allocation, or NULL if the heap is full.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void * allocTagged(int tag, int size);
+
+/*
+ * NAME :		freeTagged
+ * DESCRIPTION :
+ * 			Frees an allocation returned by allocTagged.
+ * NOTES :
+ *          Poisons the memory with ALLOC_POISON_BYTE when enabled by allocSetPoison.
+ * ARGS :
+ *          ptr   :           Allocation to free. NULL is ignored.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void freeTagged(void * ptr);
+
+/*
+ * NAME :		allocGetTagStats
+ * DESCRIPTION :
+ * 			Returns the usage stats of the given tag.
+ * NOTES :
+ * ARGS :
+ *          tag   :           AllocTag.
+ * RETURN :
+ *          Stats, or NULL if tag is out of range.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+AllocTagStats_t * allocGetTagStats(int tag);
+
+/*
+ * NAME :		allocPrintUsage
+ * DESCRIPTION :
+ * 			Prints current, peak and failed allocations for every tag.
+ * NOTES :
+ * ARGS :
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void allocPrintUsage(void);
+
+/*
+ * NAME :		allocSetPoison
+ * DESCRIPTION :
+ * 			Enables or disables poisoning freed memory with ALLOC_POISON_BYTE.
+ * NOTES :
+ *          Applies to freeTagged, allocPoolPut and allocArenaReset.
+ *          libuya isn't built with DEBUG, so DEBUG builds of the patch turn it on.
+ * ARGS :
+ *          enabled :         Non zero to poison.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void allocSetPoison(int enabled);
+
+/*
+ * NAME :		allocPoolInit
+ * DESCRIPTION :
+ * 			Allocates blockCount blocks of blockSize bytes charged to tag.
+ * NOTES :
+ *          Block sizes are rounded up to 16 bytes.
+ * ARGS :
+ *          pool        :     Pool to initialize.
+ *          tag         :     AllocTag to charge.
+ *          blockSize   :     Size of each block.
+ *          blockCount  :     Number of blocks.
+ * RETURN :
+ *          1 on success, 0 if the heap is full.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+int allocPoolInit(AllocPool_t * pool, int tag, int blockSize, int blockCount);
+
+/*
+ * NAME :		allocPoolGet
+ * DESCRIPTION :
+ * 			Takes a block from the pool.
+ * NOTES :
+ * ARGS :
+ *          pool  :           Pool.
+ * RETURN :
+ *          Block, or NULL if every block is in use.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void * allocPoolGet(AllocPool_t * pool);
+
+/*
+ * NAME :		allocPoolPut
+ * DESCRIPTION :
+ * 			Returns a block to the pool.
+ * NOTES :
+ *          Pointers that aren't a block of this pool are ignored.
+ * ARGS :
+ *          pool  :           Pool.
+ *          ptr   :           Block returned by allocPoolGet.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void allocPoolPut(AllocPool_t * pool, void * ptr);
+
+/*
+ * NAME :		allocPoolDestroy
+ * DESCRIPTION :
+ * 			Frees the pool's memory.
+ * NOTES :
+ * ARGS :
+ *          pool  :           Pool.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void allocPoolDestroy(AllocPool_t * pool);
+
+/*
+ * NAME :		allocArenaInit
+ * DESCRIPTION :
+ * 			Allocates an arena of size bytes charged to tag.
+ * NOTES :
+ * ARGS :
+ *          arena :           Arena to initialize.
+ *          tag   :           AllocTag to charge.
+ *          size  :           Size of the arena.
+ * RETURN :
+ *          1 on success, 0 if the heap is full.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+int allocArenaInit(AllocArena_t * arena, int tag, int size);
+
+/*
+ * NAME :		allocArenaGet
+ * DESCRIPTION :
+ * 			Allocates size bytes from the arena.
+ * NOTES :
+ *          Sizes are rounded up to 16 bytes. Allocations live until allocArenaReset.
+ * ARGS :
+ *          arena :           Arena.
+ *          size  :           Number of bytes to allocate.
+ * RETURN :
+ *          Pointer to the allocation, or NULL if the arena is full.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void * allocArenaGet(AllocArena_t * arena, int size);
+
+/*
+ * NAME :		allocArenaReset
+ * DESCRIPTION :
+ * 			Frees every allocation made from the arena.
+ * NOTES :
+ * ARGS :
+ *          arena :           Arena.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void allocArenaReset(AllocArena_t * arena);
+
+/*
+ * NAME :		allocArenaDestroy
+ * DESCRIPTION :
+ * 			Frees the arena's memory.
+ * NOTES :
+ *          Only for arenas created with allocArenaInit.
+ * ARGS :
+ *          arena :           Arena.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void allocArenaDestroy(AllocArena_t * arena);
+
+#endif // _LIBUYA_ALLOC_H_
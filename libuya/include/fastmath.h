@@ -0,0 +1,27 @@
+/***************************************************
+ * FILENAME :		fastmath.h
+ * DESCRIPTION :
+ * 		Polynomial trig that doesn't call into the game.
+ * NOTES :
+ * 		Shared with misc/mathtest.c, which checks the bounds below.
+ */
+
+#ifndef _LIBUYA_FASTMATH_H_
+#define _LIBUYA_FASTMATH_H_
+
+#include "common.h"
+
+//--------------------------------------------------------
+// Max absolute error against libm for |theta| <= 4pi:
+//   fastSinf/fastCosf/fastSincosf : 3.6e-6
+//   fastAtan2f                    : 2e-6
+//   fastAcosf                     : 6.8e-5
+// Unlike sinf/cosf/atan2f these don't call into the game and work on every map.
+__LIBUYA_INLINE__ float fastWrapAngle(float theta);
+__LIBUYA_INLINE__ float fastSinf(float theta);
+__LIBUYA_INLINE__ float fastCosf(float theta);
+__LIBUYA_INLINE__ void fastSincosf(float theta, float * s, float * c);
+__LIBUYA_INLINE__ float fastAtan2f(float y, float x);
+__LIBUYA_INLINE__ float fastAcosf(float v);
+
+#endif // _LIBUYA_FASTMATH_H_
@@ -853,6 +853,7 @@ void drawFunction(void);
  * DESCRIPTION :
  * 			Draws the text on the screen.
  * NOTES :
+ *          Sets font before measuring, so the returned end x is right while batching too.
  * ARGS : 
  * RETURN :
  * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
@@ -892,6 +893,77 @@ void gfxScreenSpaceBox(float x, float y, float w, float h, u32 color);
 int gfxGetFontWidth(const char * string, int length, float scale);
 void gfxPixelSpaceBox(float x, float y, float w, float h, u32 color);
 
+#define GFX_BATCH_MAX_CMDS                  (64)
+#define GFX_BATCH_TEXT_POOL_SIZE            (512)
+
+typedef struct GfxBatchStats
+{
+    int Draws;
+    int StateChanges;
+    int Bytes;
+} GfxBatchStats_t;
+
+/*
+ * NAME :		gfxBatchBegin
+ * DESCRIPTION :
+ * 			Starts recording gfxScreenSpaceBox and gfxScreenSpaceText calls instead of drawing them.
+ * NOTES :
+ *      Recorded draws are sorted by layer, primitive type and font, then drawn on gfxBatchFlush/gfxBatchEnd.
+ *      Boxes are drawn under text within the same layer.
+ *      Other draw calls are not recorded and will draw under everything in the batch.
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void gfxBatchBegin(void);
+
+/*
+ * NAME :		gfxBatchSetLayer
+ * DESCRIPTION :
+ * 			Sets the layer of subsequently recorded draws. Higher layers draw on top.
+ * NOTES :
+ * ARGS : 
+ *      layer:          Layer (0-255).
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void gfxBatchSetLayer(int layer);
+
+/*
+ * NAME :		gfxBatchFlush
+ * DESCRIPTION :
+ * 			Sorts and draws every recorded draw. Recording continues afterwards.
+ * NOTES :
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void gfxBatchFlush(void);
+
+/*
+ * NAME :		gfxBatchEnd
+ * DESCRIPTION :
+ * 			Flushes the batch and stops recording.
+ * NOTES :
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void gfxBatchEnd(void);
+
+/*
+ * NAME :		gfxBatchGetStats
+ * DESCRIPTION :
+ * 			Returns the number of draws, state changes and bytes recorded by the batch.
+ * NOTES :
+ * ARGS : 
+ *      stats:          Output stats.
+ *      reset:          Non-zero to reset the counters.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void gfxBatchGetStats(GfxBatchStats_t * stats, int reset);
+
 int gfxGetIsProgressiveScan(void);
 void gfxSetIsProgressiveScan(int on);
 
@@ -933,6 +1005,41 @@ int gfxLoadPalToGs(void* ptr, int format);
 int gfxLoadTexToGs(void* ptr, int ulog, int vlog, int format);
 PartInstance_t * gfxSpawnParticle(VECTOR position, u32 texId, u32 color, char opacity, float rotation);
 void gfxHelperAlign(float* pX, float* pY, float w, float h, enum TextAlign alignment);
+/*
+ * NAME :		gfxWorldSpaceToScreenSpace
+ * DESCRIPTION :
+ * 			Projects a world position to screen pixel coordinates using the local player's camera.
+ * NOTES :
+ * ARGS : 
+ *      position:       World position.
+ *      x:              Output screen x.
+ *      y:              Output screen y.
+ * RETURN :
+ *      Non-zero if the position is in front of the camera and on screen.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+int gfxWorldSpaceToScreenSpace(VECTOR position, int * x, int * y);
+
+/*
+ * NAME :		gfxWorldSpaceToScreenSpaceBatch
+ * DESCRIPTION :
+ * 			Projects many world positions with one camera setup.
+ * NOTES :
+ *      Points behind the camera are rejected before projecting.
+ *      x and y are only written for points that were projected.
+ * ARGS : 
+ *      positions:      World positions.
+ *      radii:          Optional bounding radius per position, may be NULL.
+ *      count:          Number of positions.
+ *      x:              Output screen x per position.
+ *      y:              Output screen y per position.
+ *      visible:        Output visibility flag per position.
+ * RETURN :
+ *      Number of visible positions.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+int gfxWorldSpaceToScreenSpaceBatch(VECTOR * positions, float * radii, int count, int * x, int * y, char * visible);
+
 void gfxHelperDrawSprite_WS(VECTOR worldPosition, float w, float h, int texId, u32 color, enum TextAlign alignment);
 void gfxHelperDrawTextWindow(float x, float y, float width, float height, float textOffsetX, float textOffsetY, float scale, u32 color, char* str, int length, enum TextAlign alignment, enum FontWindowFlags flags);
 Moby *gfxGetRegisteredDrawMobyList(void);
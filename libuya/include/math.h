@@ -40,4 +40,6 @@ __LIBUYA_INLINE__ float atan2f(float y, float x);
 __LIBUYA_INLINE__ float fastSubRots(float input0, float input1);
 __LIBUYA_INLINE__ float fastDiffRots(float input0, float input1);
 
+#include "fastmath.h"
+
 #endif // _LIBUYA_MATH_H_
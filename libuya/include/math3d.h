@@ -19,7 +19,12 @@
 #ifndef _LIBUYA_MATH3D_H_
 #define _LIBUYA_MATH3D_H_
 
+// host tools (misc/math3dtest.c) build the plain c kernels without the ps2sdk
+#ifdef MATH3D_HOST
+typedef unsigned int u128 __attribute__((__mode__(TI)));
+#else
 #include <tamtypes.h>
+#endif
 #include "common.h"
 
 //--------------------------------------------------------
@@ -87,6 +92,20 @@ void vector_sphere(VECTOR output, float radius, float angle, float elevation);
 void vector_setLength(VECTOR output, VECTOR input, float scale);
 void vector_rodrigues(VECTOR output, VECTOR input, VECTOR axis, float angle);
 
+// batched kernels, output may alias input
+void vector_apply_batch(VECTOR * output, VECTOR * input, int count, MATRIX matrix);
+void vector_lerp_batch(VECTOR * output, VECTOR * input0, VECTOR * input1, int count, float t);
+void vector_sqrdist_batch(float * output, VECTOR * input, int count, VECTOR point);
+void vector_normalize_batch(VECTOR * output, VECTOR * input, int count);
+
+// plain c versions of the batched kernels to check them against (math3dref.c)
+void vector_apply_batch_ref(VECTOR * output, VECTOR * input, int count, MATRIX matrix);
+void vector_lerp_batch_ref(VECTOR * output, VECTOR * input0, VECTOR * input1, int count, float t);
+void vector_sqrdist_batch_ref(float * output, VECTOR * input, int count, VECTOR point);
+void vector_normalize_batch_ref(VECTOR * output, VECTOR * input, int count);
+int vector_batch_compare(const char * name, float * a, float * b, int count);
+int vector_batch_selftest(void);
+
 void matrix_toeuler(VECTOR output, MATRIX input0);
 void matrix_fromrows(MATRIX output, VECTOR input0, VECTOR input1, VECTOR input2, VECTOR input3);
 void matrix_copy(MATRIX output, MATRIX input0);
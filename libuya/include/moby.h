@@ -803,6 +803,31 @@ typedef struct M6870_GatlinTurret {
 /* 0x2a0 */ int initDone;               // set to 0 on spawn; guards tracking/flash logic
 } M6870_GatlinTurret_t;
 
+/*
+ * Iterates the living mobys of a single oClass.
+ */
+typedef struct MobyClassIterator
+{
+	int OClass;
+	int Entry;
+	int EntryEnd;
+	Moby * Tail;
+} MobyClassIterator_t;
+
+/*
+ * Mobys reserved up front for a single oClass.
+ * Entries [0, Active) are in use, [Active, Count) are hidden and free.
+ */
+typedef struct MobyPool
+{
+	Moby ** Mobies;
+	int Capacity;
+	int Count;
+	int Active;
+	int OClass;
+	int PropSize;
+} MobyPool_t;
+
 
 /*
  * Spawns a moby with the given id and properties size.
@@ -831,6 +856,7 @@ __LIBUYA_GETTER__ int mobyIsDestroyed(Moby * moby);
 /*
  * Returns a pointer to the moby with the given uid.
  * Returns NULL if none found.
+ * Lookups go through a hash index that is rebuilt at most once per frame when it misses.
  */
 Moby* mobyFindByUID(int uid);
 
@@ -845,6 +871,44 @@ Moby * mobyFindNextByOClass(Moby * start, int oClass);
  */
 // int mobyClassIsLoaded(int oClass);
 
+/*
+ * NAME :		mobyClassIterBegin
+ * DESCRIPTION :
+ * 				Starts iterating the living mobys of the given oClass.
+ * 				Returns the first moby or NULL if there are none.
+ * NOTES :
+ * 				Mobys are grouped by oClass once after the level loads.
+ * 				Mobys spawned afterwards are found by scanning the end of the moby list.
+ * 				Call mobyClassIndexInvalidate after spawning mobys that may reuse freed slots.
+ * ARGS : 
+ * 				it: iterator state, owned by the caller.
+ * 				oClass: oClass to find.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+Moby * mobyClassIterBegin(MobyClassIterator_t * it, int oClass);
+
+/*
+ * NAME :		mobyClassIterNext
+ * DESCRIPTION :
+ * 				Returns the next living moby of the iterator's oClass or NULL when done.
+ * NOTES :
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+Moby * mobyClassIterNext(MobyClassIterator_t * it);
+
+/*
+ * Returns the number of living mobys of the given oClass.
+ */
+int mobyClassCount(int oClass);
+
+/*
+ * Forces the oClass index to be rebuilt on next use.
+ */
+void mobyClassIndexInvalidate(void);
+
 /*
  * Destroys the given moby.
  */
@@ -875,6 +939,11 @@ MobyFunctions * mobyGetFunctions(Moby * moby);
  */
 int mobyGetDamager(Moby * moby);
 
+/*
+ * Returns a pointer to the moby owned by the guber with the given uid.
+ * Returns NULL if none found.
+ * Lookups go through a hash index that is rebuilt at most once per frame when it misses.
+ */
 Moby* mobyGetByGuberUid(u32 uid);
 
 
@@ -891,6 +960,96 @@ ShieldVars* mobyGetShieldVars(void);
 
 void mobySetState(Moby *pMoby, char state, char stateType);
 
+/*
+ * NAME :		mobyPoolInit
+ * DESCRIPTION :
+ * 				Initializes a pool of mobys of the given oClass backed by caller owned storage.
+ * NOTES :
+ * 				Does not spawn anything. Call mobyPoolReserve once the level is loaded.
+ * ARGS : 
+ * 				pool: pool to initialize.
+ * 				storage: array of at least capacity moby pointers.
+ * 				capacity: max number of mobys the pool can hold.
+ * 				oClass: oClass of pooled mobys.
+ * 				propSize: pvar size passed to mobySpawn.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void mobyPoolInit(MobyPool_t * pool, Moby ** storage, int capacity, int oClass, int propSize);
+
+/*
+ * NAME :		mobyPoolReserve
+ * DESCRIPTION :
+ * 				Spawns hidden mobys until the pool holds count mobys.
+ * NOTES :
+ * ARGS : 
+ * RETURN :
+ * 				Returns the number of mobys held by the pool.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+int mobyPoolReserve(MobyPool_t * pool, int count);
+
+/*
+ * NAME :		mobyPoolAcquire
+ * DESCRIPTION :
+ * 				Moves a free moby to the given position and shows it.
+ * NOTES :
+ * 				Spawns a new moby if the pool is empty or the free moby was destroyed by the game.
+ * 				The caller is responsible for resetting the moby's state, update func and draw settings.
+ * ARGS : 
+ * RETURN :
+ * 				Returns NULL if no moby could be acquired.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+Moby * mobyPoolAcquire(MobyPool_t * pool, VECTOR position);
+
+/*
+ * NAME :		mobyPoolRelease
+ * DESCRIPTION :
+ * 				Hides the given moby and returns it to the pool.
+ * NOTES :
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void mobyPoolRelease(MobyPool_t * pool, Moby * moby);
+
+/*
+ * NAME :		mobyPoolDiscard
+ * DESCRIPTION :
+ * 				Removes the moby from the pool and destroys it.
+ * NOTES :
+ * 				Use for mobys whose state can't be reset.
+ * 				The next acquire spawns a fresh moby in its place.
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void mobyPoolDiscard(MobyPool_t * pool, Moby * moby);
+
+/*
+ * NAME :		mobyPoolReleaseAll
+ * DESCRIPTION :
+ * 				Hides every in use moby and returns it to the pool.
+ * NOTES :
+ * 				When not in game the pooled mobys no longer exist and the pool is emptied instead.
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void mobyPoolReleaseAll(MobyPool_t * pool);
+
+/*
+ * NAME :		mobyPoolDestroy
+ * DESCRIPTION :
+ * 				Destroys every moby held by the pool and empties it.
+ * NOTES :
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void mobyPoolDestroy(MobyPool_t * pool);
+
 /*
  * NAME :		flagIsOnSafeGround
  * DESCRIPTION :
@@ -21,8 +21,15 @@
 // skips aggregation
 #define NET_LATENCY_CRITICAL                        (0x80)
 
+// direction passed to the record callback
+#define NET_RECORD_RECV                             (0)
+#define NET_RECORD_SEND                             (1)
+
 typedef int (*NET_CALLBACK_DELEGATE)(void * connection, void * data);
 
+// clientIndex is -1 for broadcasts and received messages
+typedef void (*NET_RECORD_DELEGATE)(int direction, int clientIndex, u8 customMsgId, int msgSize, void * payload);
+
 typedef enum eNW_STATE {
 	eNW_STATE_NONE = 0,
 	eNW_STATE_NETCONFIGED = 1,
@@ -46,6 +53,9 @@ int netSendCustomAppMessage(void * connection, int clientIndex, u8 customMsgId,
 int netBroadcastMediusAppMessage(void * connection, int msgId, int msgSize, void * payload);
 int netBroadcastCustomAppMessage(void * connection, u8 customMsgId, int msgSize, void * payload);
 
+// observes every custom message handled or sent, NULL to stop
+void netSetRecordCallback(NET_RECORD_DELEGATE callback);
+
 void* netGetLobbyServerConnection(void);
 void* netGetDmeServerConnection(void);
 
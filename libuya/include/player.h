@@ -1696,4 +1696,44 @@ int playerGetLatency(Player *player);
 */
 int playerIsLinkHealthy(Player *player);
 
+#define PLAYER_ROSTER_NAME_HASH_SIZE				(16)
+#define PLAYER_ROSTER_NAME_LENGTH					(16)
+
+/*
+ * Snapshot of every player in the game, rebuilt at most once per frame.
+ * Masks are indexed by player slot.
+ */
+typedef struct PlayerRoster
+{
+	Player * Players[GAME_MAX_PLAYERS];
+	VECTOR Positions[GAME_MAX_PLAYERS];
+	u8 TeamMasks[GAME_MAX_PLAYERS];
+	u8 PresentMask;
+	u8 LocalMask;
+	u8 AliveMask;
+	u8 Count;
+	u8 NameHash[PLAYER_ROSTER_NAME_HASH_SIZE];
+	int Frame;
+} PlayerRoster_t;
+
+/*
+* NAME :		playerGetRoster
+* DESCRIPTION : Returns the player roster for the current frame.
+* NOTES :		The roster is rebuilt on the first call each frame.
+* ARGS : 		
+* RETURN :		Pointer to the roster.
+* AUTHOR :		Daniel "Dnawrkshp" Gerendasy
+*/
+PlayerRoster_t * playerGetRoster(void);
+
+/*
+* NAME :		playerRosterFindByName
+* DESCRIPTION : Returns the slot of the player with the given name.
+* NOTES :
+* ARGS : 		name: player name, compared up to PLAYER_ROSTER_NAME_LENGTH characters
+* RETURN :		Player slot, or -1 if no player has that name.
+* AUTHOR :		Daniel "Dnawrkshp" Gerendasy
+*/
+int playerRosterFindByName(char * name);
+
 #endif // _LIBUYA_PLAYER_H_
@@ -19,6 +19,10 @@
 #define COUNT_SET_BITS(mask) __builtin_popcount(mask)
 #define FLOAT_TO_U16(f) ((u16)((*(u32*)&(f)) >> 16))
 
+#define FRAME_ARENA_SIZE                    (0x2000)
+#define FNV1A_OFFSET_BASIS                  (2166136261u)
+#define FNV1A_PRIME                         (16777619u)
+
 /*
  * NAME :		isInEEMemory
  * DESCRIPTION :
@@ -67,4 +71,69 @@ int isInIopMemory(void* p);
  */
 int ConvertJALtoAddress(int instruction);
 
+/*
+ * NAME :		frameArenaAlloc
+ * DESCRIPTION :
+ * 			Allocates temporary memory that is valid until the end of the current frame.
+ * NOTES :
+ *          The arena is reset on the first allocation of each frame.
+ *          Allocations are aligned to 16 bytes.
+ * ARGS : 
+ *          size  :           Number of bytes to allocate.
+ * RETURN :
+ *          Pointer to the allocation, or NULL if the arena is full.
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void * frameArenaAlloc(int size);
+
+/*
+ * NAME :		frameArenaGetFree
+ * DESCRIPTION :
+ * 			Returns the number of bytes left in the frame arena this frame.
+ * NOTES :
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+int frameArenaGetFree(void);
+
+/*
+ * NAME :		frameArenaGetHighWaterMark
+ * DESCRIPTION :
+ * 			Returns the most bytes the frame arena has had allocated in a single frame.
+ * NOTES :
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+int frameArenaGetHighWaterMark(void);
+
+/*
+ * NAME :		fnv1a
+ * DESCRIPTION :
+ * 			Returns the 32 bit FNV-1a hash of size bytes.
+ * NOTES :
+ * ARGS : 
+ *          data  :           Bytes to hash.
+ *          size  :           Number of bytes.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+u32 fnv1a(void * data, int size);
+
+/*
+ * NAME :		fnv1aString
+ * DESCRIPTION :
+ * 			Returns the 32 bit FNV-1a hash of a string.
+ * NOTES :
+ *          Stops at the null terminator or after maxLength characters,
+ *          so fixed size fields without a terminator can be hashed.
+ * ARGS : 
+ *          str       :       String to hash.
+ *          maxLength :       Most characters to hash.
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+u32 fnv1aString(char * str, int maxLength);
+
 #endif // _LIBUYA_UTILS_H_
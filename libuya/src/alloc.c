@@ -0,0 +1,231 @@
+#ifdef ALLOC_HOST
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define DPRINTF(fmt, ...)
+#else
+#include <tamtypes.h>
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#endif
+#include "alloc.h"
+
+#define ALLOC_HEADER_MAGIC                  (0x434F4C41) // ALOC
+
+// prefixed to every tagged allocation
+typedef struct AllocHeader
+{
+    u32 Magic;
+    short Tag;
+    short Pad;
+    int Size;
+    int Pad2;
+} AllocHeader_t;
+
+AllocTagStats_t AllocTagStats[ALLOC_TAG_COUNT];
+int AllocPoison = 0;
+
+const char * AllocTagNames[ALLOC_TAG_COUNT] = {
+    [ALLOC_TAG_DEFAULT] "default",
+    [ALLOC_TAG_PATCH] "patch",
+    [ALLOC_TAG_PLAYERSYNC] "playersync",
+    [ALLOC_TAG_MAPLOADER] "maploader",
+    [ALLOC_TAG_NET] "net",
+    [ALLOC_TAG_GAMEMODE] "gamemode",
+};
+
+//--------------------------------------------------------------------------------
+void * allocTagged(int tag, int size)
+{
+    if (tag < 0 || tag >= ALLOC_TAG_COUNT)
+        tag = ALLOC_TAG_DEFAULT;
+
+    AllocTagStats_t* stats = &AllocTagStats[tag];
+    AllocHeader_t* header = NULL;
+    if (size >= 0)
+        header = malloc(sizeof(AllocHeader_t) + size);
+
+    if (!header) {
+        stats->Failed += 1;
+        return NULL;
+    }
+
+    header->Magic = ALLOC_HEADER_MAGIC;
+    header->Tag = tag;
+    header->Size = size;
+    stats->Allocs += 1;
+    stats->Current += size;
+    if (stats->Current > stats->Peak)
+        stats->Peak = stats->Current;
+
+    return header + 1;
+}
+
+//--------------------------------------------------------------------------------
+void freeTagged(void * ptr)
+{
+    if (!ptr)
+        return;
+
+    AllocHeader_t* header = (AllocHeader_t*)ptr - 1;
+    if (header->Magic != ALLOC_HEADER_MAGIC) {
+        DPRINTF("freeTagged: %p was not allocated with allocTagged\n", ptr);
+        return;
+    }
+
+    AllocTagStats_t* stats = &AllocTagStats[header->Tag];
+    stats->Frees += 1;
+    stats->Current -= header->Size;
+
+    if (AllocPoison)
+        memset(ptr, ALLOC_POISON_BYTE, header->Size);
+
+    header->Magic = 0;
+    free(header);
+}
+
+//--------------------------------------------------------------------------------
+AllocTagStats_t * allocGetTagStats(int tag)
+{
+    if (tag < 0 || tag >= ALLOC_TAG_COUNT)
+        return NULL;
+
+    return &AllocTagStats[tag];
+}
+
+//--------------------------------------------------------------------------------
+void allocPrintUsage(void)
+{
+    int i;
+
+    printf("%-12s %8s %8s %7s %7s %6s\n", "tag", "current", "peak", "allocs", "frees", "failed");
+    for (i = 0; i < ALLOC_TAG_COUNT; ++i) {
+        AllocTagStats_t* stats = &AllocTagStats[i];
+        printf("%-12s %8d %8d %7d %7d %6d\n", AllocTagNames[i], stats->Current, stats->Peak, stats->Allocs, stats->Frees, stats->Failed);
+    }
+}
+
+//--------------------------------------------------------------------------------
+void allocSetPoison(int enabled)
+{
+    AllocPoison = enabled;
+}
+
+//--------------------------------------------------------------------------------
+int allocPoolInit(AllocPool_t * pool, int tag, int blockSize, int blockCount)
+{
+    int i;
+
+    memset(pool, 0, sizeof(AllocPool_t));
+    if (blockSize <= 0 || blockCount <= 0)
+        return 0;
+
+    blockSize = (blockSize + 0xF) & ~0xF;
+    pool->Buffer = allocTagged(tag, blockSize * blockCount);
+    if (!pool->Buffer)
+        return 0;
+
+    pool->BlockSize = blockSize;
+    pool->BlockCount = blockCount;
+
+    // thread every block onto the free list, lowest address first
+    for (i = blockCount - 1; i >= 0; --i) {
+        void** block = (void**)(pool->Buffer + (i * blockSize));
+        *block = pool->FreeList;
+        pool->FreeList = block;
+    }
+
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+void * allocPoolGet(AllocPool_t * pool)
+{
+    void** block = (void**)pool->FreeList;
+    if (!block) {
+        pool->Failed += 1;
+        return NULL;
+    }
+
+    pool->FreeList = *block;
+    pool->Used += 1;
+    if (pool->Used > pool->Peak)
+        pool->Peak = pool->Used;
+
+    return block;
+}
+
+//--------------------------------------------------------------------------------
+void allocPoolPut(AllocPool_t * pool, void * ptr)
+{
+    if (!ptr || !pool->Buffer)
+        return;
+
+    int offset = (u8*)ptr - pool->Buffer;
+    if (offset < 0 || offset >= pool->BlockSize * pool->BlockCount || (offset % pool->BlockSize) != 0) {
+        DPRINTF("allocPoolPut: %p is not a block of this pool\n", ptr);
+        return;
+    }
+
+    if (AllocPoison)
+        memset(ptr, ALLOC_POISON_BYTE, pool->BlockSize);
+
+    *(void**)ptr = pool->FreeList;
+    pool->FreeList = ptr;
+    pool->Used -= 1;
+}
+
+//--------------------------------------------------------------------------------
+void allocPoolDestroy(AllocPool_t * pool)
+{
+    freeTagged(pool->Buffer);
+    memset(pool, 0, sizeof(AllocPool_t));
+}
+
+//--------------------------------------------------------------------------------
+int allocArenaInit(AllocArena_t * arena, int tag, int size)
+{
+    memset(arena, 0, sizeof(AllocArena_t));
+    size = (size + 0xF) & ~0xF;
+
+    arena->Buffer = allocTagged(tag, size);
+    if (!arena->Buffer)
+        return 0;
+
+    arena->Size = size;
+    return 1;
+}
+
+//--------------------------------------------------------------------------------
+void * allocArenaGet(AllocArena_t * arena, int size)
+{
+    int offset = arena->Offset;
+    int end = offset + ((size + 0xF) & ~0xF);
+    if (!arena->Buffer || size < 0 || end > arena->Size) {
+        arena->Failed += 1;
+        return NULL;
+    }
+
+    arena->Offset = end;
+    if (end > arena->Peak)
+        arena->Peak = end;
+
+    return arena->Buffer + offset;
+}
+
+//--------------------------------------------------------------------------------
+void allocArenaReset(AllocArena_t * arena)
+{
+    if (AllocPoison && arena->Buffer)
+        memset(arena->Buffer, ALLOC_POISON_BYTE, arena->Offset);
+
+    arena->Offset = 0;
+}
+
+//--------------------------------------------------------------------------------
+void allocArenaDestroy(AllocArena_t * arena)
+{
+    freeTagged(arena->Buffer);
+    memset(arena, 0, sizeof(AllocArena_t));
+}
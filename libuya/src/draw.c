@@ -1,6 +1,7 @@
 #include "common.h"
 #include "player.h"
 #include "graphics.h"
+#include "utils.h"
 
 typedef enum LineStyle {
     LINE_STYLE_NONE = 0,
@@ -88,14 +89,6 @@ void drawLines(LineEndPoint_t *pEndPoints, int numEndPoints, LineStatic_t *pStyl
     if (numEndPoints < 2) return;
     if (!pStyle) pStyle = &BeamLineStyle;
 
-    // Initialize drawing state
-    gfxDrawStripInit();
-    gfxAddRegister(8, 0);
-    gfxAddRegister(0x14, 0xff9000000260);
-    gfxAddRegister(6, gfxGetEffectTex(pStyle->texture));
-    gfxAddRegister(0x47, 0x513f1);
-    gfxAddRegister(0x42, 0x8000000044);
-
     // Calculate animated texture offset
     float animatedUVOffset = pStyle->textureOffset;
     
@@ -106,26 +99,53 @@ void drawLines(LineEndPoint_t *pEndPoints, int numEndPoints, LineStatic_t *pStyl
         animatedUVOffset += scrollDirection * ((float)(gameGetTime() % absFrames) / (float)absFrames);
     }
 
+    // strip buffers live in the frame arena
+    // each of the three allocations may lose up to 15 bytes to alignment
+    int maxPoints = (frameArenaGetFree() - (3 * 0xF)) / (int)(sizeof(vec3) + sizeof(int) + sizeof(UV_t));
+
     // Count total segments needed
+    // and drop the trailing end points that don't fit in the arena
     int totalSegments = 0;
     int i;
     for (i = 0; i < numEndPoints - 1; i++) {
+        LineStatic_t *segmentStyle = pStyle;
+        if (pEndPoints[i].style > LINE_STYLE_NONE && pEndPoints[i].style < LINE_STYLE_NUM_STYLES) {
+            segmentStyle = LineStyles[pEndPoints[i].style];
+        }
+
         VECTOR delta;
         vector_subtract(delta, pEndPoints[i + 1].pos, pEndPoints[i].pos);
         float len = vector_length(delta);
 
-        int segs = pStyle->numSegments;
+        int segs = segmentStyle->numSegments;
         if (segs <= 0) {
-            segs = (int)(len / pStyle->textureRepeatDistance);
+            segs = (int)(len / segmentStyle->textureRepeatDistance);
             if (segs < 1) segs = 1;
         }
+
+        if ((totalSegments + segs + 1) * 2 > maxPoints) {
+            numEndPoints = i + 1;
+            break;
+        }
         totalSegments += segs;
     }
 
+    if (numEndPoints < 2) return;
+
     int numPoints = (totalSegments + 1) * 2;
-    vec3 stripPos[numPoints];
-    int stripColor[numPoints];
-    UV_t stripUV[numPoints];
+    vec3 * stripPos = frameArenaAlloc(numPoints * sizeof(vec3));
+    int * stripColor = frameArenaAlloc(numPoints * sizeof(int));
+    UV_t * stripUV = frameArenaAlloc(numPoints * sizeof(UV_t));
+    if (!stripPos || !stripColor || !stripUV)
+        return;
+
+    // Initialize drawing state
+    gfxDrawStripInit();
+    gfxAddRegister(8, 0);
+    gfxAddRegister(0x14, 0xff9000000260);
+    gfxAddRegister(6, gfxGetEffectTex(pStyle->texture));
+    gfxAddRegister(0x47, 0x513f1);
+    gfxAddRegister(0x42, 0x8000000044);
 
     float distanceAccum = 0.0f;
     int vertexIndex = 0;
@@ -257,10 +277,14 @@ void drawLines(LineEndPoint_t *pEndPoints, int numEndPoints, LineStatic_t *pStyl
                 float angle1 = (float)((vertexIndex * 137) % 360) * (3.14159f / 180.0f);
                 float angle2 = (float)((vertexIndex * 211) % 360) * (3.14159f / 180.0f);
                 
+                float sin1, cos1, sin2, cos2;
+                fastSincosf(angle1, &sin1, &cos1);
+                fastSincosf(angle2, &sin2, &cos2);
+
                 VECTOR randomDir;
-                randomDir[0] = cosf(angle1) * cosf(angle2);
-                randomDir[1] = sinf(angle2);
-                randomDir[2] = sinf(angle1) * cosf(angle2);
+                randomDir[0] = cos1 * cos2;
+                randomDir[1] = sin2;
+                randomDir[2] = sin1 * cos2;
                 randomDir[3] = 0;
                 
                 vector_scale(randomDir, randomDir, segmentStyle->pointRandomOffset);  // Fixed: Use segmentStyle
@@ -0,0 +1,103 @@
+// shared with misc/mathtest.c, so this file must not depend on the rest of libuya
+#ifdef MATH_HOST
+#include <math.h>
+#include <stddef.h>
+#else
+#include <tamtypes.h>
+#include "math.h"
+#endif
+#include "fastmath.h"
+
+//--------------------------------------------------------
+// fast trig
+// polynomial approximations that don't depend on the game's per map sinf/cosf/atan2f
+// so they also work in the lobby and while loading
+//--------------------------------------------------------
+#define FAST_PI                         (3.14159265f)
+#define FAST_TAU                        (6.28318531f)
+#define FAST_HALF_PI                    (1.57079633f)
+
+//--------------------------------------------------------
+float fastWrapAngle(float theta)
+{
+    float n = theta * (1.0f / FAST_TAU);
+    int k = (int)(n + ((n < 0) ? -0.5f : 0.5f));
+    return theta - (float)k * FAST_TAU;
+}
+
+//--------------------------------------------------------
+void fastSincosf(float theta, float * s, float * c)
+{
+    float x = fastWrapAngle(theta);
+    float sign = 1;
+
+    // fold into [-pi/2, pi/2]
+    if (x > FAST_HALF_PI) {
+        x = FAST_PI - x;
+        sign = -1;
+    } else if (x < -FAST_HALF_PI) {
+        x = -FAST_PI - x;
+        sign = -1;
+    }
+
+    // taylor series to x^11 and x^10
+    float x2 = x * x;
+    if (s)
+        *s = x * (1.0f + x2 * (-1.6666667e-1f + x2 * (8.3333333e-3f + x2 * (-1.9841270e-4f + x2 * (2.7557319e-6f + x2 * -2.5052108e-8f)))));
+    if (c)
+        *c = sign * (1.0f + x2 * (-0.5f + x2 * (4.1666667e-2f + x2 * (-1.3888889e-3f + x2 * (2.4801587e-5f + x2 * -2.7557319e-7f)))));
+}
+
+//--------------------------------------------------------
+float fastSinf(float theta)
+{
+    float s;
+    fastSincosf(theta, &s, NULL);
+    return s;
+}
+
+//--------------------------------------------------------
+float fastCosf(float theta)
+{
+    float c;
+    fastSincosf(theta, NULL, &c);
+    return c;
+}
+
+//--------------------------------------------------------
+float fastAtan2f(float y, float x)
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float mx = (ax < ay) ? ay : ax;
+    float mn = (ax < ay) ? ax : ay;
+    if (mx == 0)
+        return 0;
+
+    // minimax atan on [0, 1]
+    float z = mn / mx;
+    float z2 = z * z;
+    float r = z * (0.99997726f + z2 * (-0.33262347f + z2 * (0.19354346f + z2 * (-0.11643287f + z2 * (0.05265332f + z2 * -0.01172120f)))));
+
+    // rebuild octant
+    if (ay > ax)
+        r = FAST_HALF_PI - r;
+    if (x < 0)
+        r = FAST_PI - r;
+    if (y < 0)
+        r = -r;
+
+    return r;
+}
+
+//--------------------------------------------------------
+float fastAcosf(float v)
+{
+    float a = fabsf(v);
+    if (a > 1)
+        a = 1;
+
+    // abramowitz and stegun 4.4.45
+    float r = sqrtf(1.0f - a) * (1.5707288f + a * (-0.2121144f + a * (0.0742610f + a * -0.0187293f)));
+    return (v < 0) ? (FAST_PI - r) : r;
+}
@@ -5,6 +5,7 @@
 #include "gamesettings.h"
 #include "gamesettings.h"
 #include "hud.h"
+#include "string.h"
 
 #if UYA_PAL
 #define IS_PROGRESSIVE_SCAN					(*(int*)0x002413a0)
@@ -23,6 +24,40 @@ int internal_drawFunc(float, float, float, float, float, float, u32, const char*
 void internal_drawBox(void *, void *);
 void internal_WorldSpaceToScreenSpace(VECTOR *, VECTOR);
 
+enum GfxBatchCmdType
+{
+    GFX_BATCH_CMD_BOX = 0,
+    GFX_BATCH_CMD_TEXT = 1,
+};
+
+typedef struct GfxBatchCmd
+{
+    u32 SortKey;
+    float X;
+    float Y;
+    float W; // text scale x
+    float H; // text scale y
+    u32 Color;
+    short TextOffset;
+    char Alignment;
+    char Font;
+} GfxBatchCmd_t;
+
+// deferred screen space draws between gfxBatchBegin and gfxBatchFlush
+struct GfxBatch
+{
+    int Active;
+    int Layer;
+    int Count;
+    int TextPoolUsed;
+    GfxBatchStats_t Stats;
+    GfxBatchCmd_t Cmds[GFX_BATCH_MAX_CMDS];
+    char TextPool[GFX_BATCH_TEXT_POOL_SIZE];
+} GfxBatch;
+
+int gfxBatchPushBox(float x, float y, float w, float h, u32 color);
+int gfxBatchPushText(float x, float y, float scaleX, float scaleY, u32 color, const char * string, int length, int alignment, int font);
+
 
 // drawTextFunc -> widthFunc Offset: -0x2a0
 VariableAddress_t vaFontPrintFunc = {
@@ -953,7 +988,12 @@ VariableAddress_t vaWorldSpaceToMapSpaceFromPosition = {
 //--------------------------------------------------------
 int gfxScreenSpaceText(float x, float y, float scaleX, float scaleY, u32 color, const char * string, int length, int alignment, int font)
 {
+    // the width is measured with the current font, so set it either way
+    // batched text sets its font again once per run when the batch is flushed
     gfxSetFont(font);
+    if (GfxBatch.Active && gfxBatchPushText(x, y, scaleX, scaleY, color, string, length, alignment, font))
+        return x + gfxGetFontWidth(string, length, scaleX);
+
     // float x, float y, float scaleX, float scaleY, float shadowX, float shadowY, u32 color, const char* string, u64 length, u64 alignment, int bold, u32 shadowColor
     internal_drawFunc(x, y, scaleX, scaleY, 1, 1, color, string, length, alignment, 1, 0x80000000);
     return x + gfxGetFontWidth(string, length, scaleX);
@@ -1009,6 +1049,9 @@ void gfxScreenSpaceQuad(RECT * rect, u32 colorTL, u32 colorTR, u32 colorBL, u32
 //--------------------------------------------------------
 void gfxScreenSpaceBox(float x, float y, float w, float h, u32 color)
 {
+    if (GfxBatch.Active && gfxBatchPushBox(x, y, w, h, color))
+        return;
+
     // crop (xOff, yOff, width, height)
     float arg2[4] = {
         0, 0, 1, 1
@@ -1157,40 +1200,56 @@ int gfxIsInView(Player *player, VECTOR position)
     return output;
 }
 
-int gfxWorldSpaceToScreenSpace(VECTOR position, int * x, int * y)
+//--------------------------------------------------------
+int gfxWorldSpaceToScreenSpaceBatch(VECTOR * positions, float * radii, int count, int * x, int * y, char * visible)
 {
+    int i;
+    int visibleCount = 0;
     Player *player = playerGetFromSlot(0);
-    if (!player)
+
+    memset(visible, 0, count);
+    if (!player || !player->camera)
         return 0;
 
-	VECTOR screenPos;
-    VECTOR toMoby;
+    // view setup shared by every point
+    VECTOR screenPos;
+    VECTOR toPoint;
     VECTOR cameraDir = {player->camera->uMtx.v0[1], player->camera->uMtx.v1[1], player->camera->uMtx.v2[1], 0};
     VECTOR offsetCamDir = {0, 0, 4, 0};
     float scale = 0.0625;
+    int limX = SCREEN->lim_x + 64;
+    int limY = SCREEN->lim_y + 64;
 
-    vector_subtract(toMoby, position, player->camera->pos);
-    vector_normalize(toMoby, toMoby);
     vector_add(offsetCamDir, cameraDir, offsetCamDir);
     vector_normalize(offsetCamDir, offsetCamDir);
-    float dot = vector_innerproduct_unscaled(offsetCamDir, toMoby);
-    // dot needs to be negated when online.
-    if (dot > 0)
-        return 0;
 
-    // if(dot > 0) {
-    //     printf("\nlooking at moby");
-    // } else {
-    //     printf("\nhaha you're blind. :(");
-    //     return 0;
-    // }
-
-	internal_WorldSpaceToScreenSpace(&screenPos, position);
-    *x = (int)((screenPos[0] - SCREEN->ofs_x) * scale);
-    *y = (int)((screenPos[1] - SCREEN->ofs_y) * scale);
-    if (*x < -64 || *x > SCREEN->lim_x + 64) return 0;
-    if (*y < -64 || *y > SCREEN->lim_y + 64) return 0;
-    return 1;
+    for (i = 0; i < count; ++i) {
+        // reject points behind the camera before projecting
+        // dot needs to be negated when online.
+        vector_subtract(toPoint, positions[i], player->camera->pos);
+        float dot = vector_innerproduct_unscaled(offsetCamDir, toPoint);
+        if (dot > (radii ? radii[i] : 0))
+            continue;
+
+        internal_WorldSpaceToScreenSpace(&screenPos, positions[i]);
+        x[i] = (int)((screenPos[0] - SCREEN->ofs_x) * scale);
+        y[i] = (int)((screenPos[1] - SCREEN->ofs_y) * scale);
+        if (x[i] < -64 || x[i] > limX) continue;
+        if (y[i] < -64 || y[i] > limY) continue;
+
+        visible[i] = 1;
+        ++visibleCount;
+    }
+
+    return visibleCount;
+}
+
+//--------------------------------------------------------
+int gfxWorldSpaceToScreenSpace(VECTOR position, int * x, int * y)
+{
+    char visible;
+    gfxWorldSpaceToScreenSpaceBatch((VECTOR*)position, NULL, 1, x, y, &visible);
+    return visible;
 }
 
 void gfxHelperDrawSprite_WS(VECTOR worldPosition, float w, float h, int texId, u32 color, enum TextAlign alignment)
@@ -1280,3 +1339,137 @@ void gfxGetMapSpaceFromMobyIndex(int mobyIndex, float *output_x, float *output_y
 {
     gfxMapSpaceFromMoby(&((Moby*)mobyListGetStart())[mobyIndex], output_x, output_y);
 }
+
+//--------------------------------------------------------
+// sort key is layer, then primitive type, then font, then submission order
+// so boxes stay under text and draws within a key keep their order
+u32 gfxBatchSortKey(int type, int font)
+{
+    return ((GfxBatch.Layer & 0xFF) << 24) | ((type & 0xF) << 20) | ((font & 0xF) << 16) | (GfxBatch.Count & 0xFFFF);
+}
+
+//--------------------------------------------------------
+int gfxBatchPushBox(float x, float y, float w, float h, u32 color)
+{
+    if (GfxBatch.Count >= GFX_BATCH_MAX_CMDS)
+        gfxBatchFlush();
+
+    GfxBatchCmd_t * cmd = &GfxBatch.Cmds[GfxBatch.Count];
+    cmd->SortKey = gfxBatchSortKey(GFX_BATCH_CMD_BOX, 0);
+    cmd->X = x;
+    cmd->Y = y;
+    cmd->W = w;
+    cmd->H = h;
+    cmd->Color = color;
+    ++GfxBatch.Count;
+    GfxBatch.Stats.Bytes += sizeof(GfxBatchCmd_t);
+    return 1;
+}
+
+//--------------------------------------------------------
+int gfxBatchPushText(float x, float y, float scaleX, float scaleY, u32 color, const char * string, int length, int alignment, int font)
+{
+    if (!string)
+        return 0;
+
+    int len = strlen(string);
+    if (length >= 0 && length < len)
+        len = length;
+
+    // strings can be temporary so copy them into the pool
+    if (GfxBatch.Count >= GFX_BATCH_MAX_CMDS || (GfxBatch.TextPoolUsed + len + 1) > GFX_BATCH_TEXT_POOL_SIZE)
+        gfxBatchFlush();
+    if ((len + 1) > GFX_BATCH_TEXT_POOL_SIZE)
+        return 0;
+
+    GfxBatchCmd_t * cmd = &GfxBatch.Cmds[GfxBatch.Count];
+    cmd->SortKey = gfxBatchSortKey(GFX_BATCH_CMD_TEXT, font);
+    cmd->X = x;
+    cmd->Y = y;
+    cmd->W = scaleX;
+    cmd->H = scaleY;
+    cmd->Color = color;
+    cmd->TextOffset = GfxBatch.TextPoolUsed;
+    cmd->Alignment = alignment;
+    cmd->Font = font;
+    memcpy(GfxBatch.TextPool + GfxBatch.TextPoolUsed, string, len);
+    GfxBatch.TextPool[GfxBatch.TextPoolUsed + len] = 0;
+    GfxBatch.TextPoolUsed += len + 1;
+    ++GfxBatch.Count;
+    GfxBatch.Stats.Bytes += sizeof(GfxBatchCmd_t) + len + 1;
+    return 1;
+}
+
+//--------------------------------------------------------
+void gfxBatchBegin(void)
+{
+    GfxBatch.Active = 1;
+    GfxBatch.Layer = 0;
+}
+
+//--------------------------------------------------------
+void gfxBatchSetLayer(int layer)
+{
+    GfxBatch.Layer = layer;
+}
+
+//--------------------------------------------------------
+void gfxBatchFlush(void)
+{
+    int i, j;
+    int lastType = -1;
+    int lastFont = -1;
+    int active = GfxBatch.Active;
+
+    // insertion sort, batches are small and mostly in order
+    for (i = 1; i < GfxBatch.Count; ++i) {
+        GfxBatchCmd_t cmd = GfxBatch.Cmds[i];
+        for (j = i - 1; j >= 0 && GfxBatch.Cmds[j].SortKey > cmd.SortKey; --j)
+            GfxBatch.Cmds[j + 1] = GfxBatch.Cmds[j];
+        GfxBatch.Cmds[j + 1] = cmd;
+    }
+
+    // issue draws immediately while flushing
+    GfxBatch.Active = 0;
+    for (i = 0; i < GfxBatch.Count; ++i) {
+        GfxBatchCmd_t * cmd = &GfxBatch.Cmds[i];
+        int type = (cmd->SortKey >> 20) & 0xF;
+        if (type != lastType) {
+            lastType = type;
+            ++GfxBatch.Stats.StateChanges;
+        }
+
+        if (type == GFX_BATCH_CMD_TEXT) {
+            if (cmd->Font != lastFont) {
+                lastFont = cmd->Font;
+                gfxSetFont(cmd->Font);
+                ++GfxBatch.Stats.StateChanges;
+            }
+            internal_drawFunc(cmd->X, cmd->Y, cmd->W, cmd->H, 1, 1, cmd->Color, GfxBatch.TextPool + cmd->TextOffset, -1, cmd->Alignment, 1, 0x80000000);
+        } else {
+            gfxScreenSpaceBox(cmd->X, cmd->Y, cmd->W, cmd->H, cmd->Color);
+        }
+
+        ++GfxBatch.Stats.Draws;
+    }
+
+    GfxBatch.Active = active;
+    GfxBatch.Count = 0;
+    GfxBatch.TextPoolUsed = 0;
+}
+
+//--------------------------------------------------------
+void gfxBatchEnd(void)
+{
+    gfxBatchFlush();
+    GfxBatch.Active = 0;
+}
+
+//--------------------------------------------------------
+void gfxBatchGetStats(GfxBatchStats_t * stats, int reset)
+{
+    if (stats)
+        memcpy(stats, &GfxBatch.Stats, sizeof(GfxBatchStats_t));
+    if (reset)
+        memset(&GfxBatch.Stats, 0, sizeof(GfxBatchStats_t));
+}
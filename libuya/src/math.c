@@ -210,4 +210,4 @@ float sqrtf(float x)
         : "f"(x)
         );
     return out;
-    }
\ No newline at end of file
+    }
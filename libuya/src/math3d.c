@@ -2,6 +2,7 @@
 #include "math.h"
 #include "math3d.h"
 #include "stdio.h"
+#include "time.h"
 #include <tamtypes.h>
   
 /*
@@ -37,8 +38,7 @@ void vector_reflect(VECTOR output, VECTOR input0, VECTOR normal)
 //--------------------------------------------------------
 void vector_fromyaw(VECTOR out, float radians)
 {
-	out[0] = cosf(radians),
-	out[1] = sinf(radians),
+	fastSincosf(radians, &out[1], &out[0]);
 	out[2] = 0;
 	out[3] = 0;
 }
@@ -375,10 +375,9 @@ void vector_transform(VECTOR output, VECTOR input, MATRIX matrix) {
 
 void vector_sphere(VECTOR output, float radius, float angle, float elevation)
 {
-    float sin_elv = sinf(elevation);
-    float cos_elv = cosf(elevation);
-    float sin_ang = sinf(angle);
-    float cos_ang = cosf(angle);
+    float sin_elv, cos_elv, sin_ang, cos_ang;
+    fastSincosf(elevation, &sin_elv, &cos_elv);
+    fastSincosf(angle, &sin_ang, &cos_ang);
     output[0] = radius * cos_elv * sin_ang;
     output[1] = radius * sin_elv;
     output[2] = radius * cos_elv * cos_ang;
@@ -393,8 +392,8 @@ void vector_setLength(VECTOR output, VECTOR input, float scale) {
 void vector_rodrigues(VECTOR output, VECTOR input, VECTOR axis, float angle)
 {
     VECTOR k, v_cross, term1, term2, term3;
-    float cosTheta = cosf(angle);
-    float sinTheta = sinf(angle);
+    float cosTheta, sinTheta;
+    fastSincosf(angle, &sinTheta, &cosTheta);
 
     // normalize axis into k
     vector_normalize(k, axis);
@@ -419,6 +418,259 @@ void vector_rodrigues(VECTOR output, VECTOR input, VECTOR axis, float angle)
 }
 
 
+//--------------------------------------------------------
+// batched kernels
+// shared operands are loaded into VU0 once and stay resident for every element
+// gcc doesn't allocate the vf registers, so each kernel keeps its whole loop
+// in one asm block and nothing can use VU0 between iterations
+//--------------------------------------------------------
+void vector_apply_batch(VECTOR * output, VECTOR * input, int count, MATRIX matrix)
+{
+    if (count <= 0)
+        return;
+
+    asm __volatile__ (
+    ".set push      \n"
+    ".set reorder   \n"
+#if __GNUC__ > 3
+    "lqc2   $vf1, 0x00(%3)  \n"
+    "lqc2   $vf2, 0x10(%3)  \n"
+    "lqc2   $vf3, 0x20(%3)  \n"
+    "lqc2   $vf4, 0x30(%3)  \n"
+    "1:     \n"
+    "lqc2   $vf5, 0x00(%1)  \n"
+    "vmulaw   $ACC, $vf4, $vf0  \n"
+    "vmaddax    $ACC, $vf1, $vf5  \n"
+    "vmadday    $ACC, $vf2, $vf5  \n"
+    "vmaddz   $vf6, $vf3, $vf5  \n"
+    "sqc2   $vf6, 0x00(%0)  \n"
+#else
+    "lqc2		vf1, 0x00(%3)	\n"
+    "lqc2		vf2, 0x10(%3)	\n"
+    "lqc2		vf3, 0x20(%3)	\n"
+    "lqc2		vf4, 0x30(%3)	\n"
+    "1:				\n"
+    "lqc2		vf5, 0x00(%1)	\n"
+    "vmulaw		ACC, vf4, vf0	\n"
+    "vmaddax		ACC, vf1, vf5	\n"
+    "vmadday		ACC, vf2, vf5	\n"
+    "vmaddz		vf6, vf3, vf5	\n"
+    "sqc2		vf6, 0x00(%0)	\n"
+#endif
+    "addiu  %0, %0, 0x10    \n"
+    "addiu  %1, %1, 0x10    \n"
+    "addiu  %2, %2, -1      \n"
+    "bgtz   %2, 1b          \n"
+    ".set pop       \n"
+    : "+r" (output), "+r" (input), "+r" (count)
+    : "r" (matrix)
+    : "memory"
+    );
+}
+
+//--------------------------------------------------------
+void vector_lerp_batch(VECTOR * output, VECTOR * input0, VECTOR * input1, int count, float t)
+{
+    VECTOR timeVector;
+    timeVector[0] = t;
+
+    if (count <= 0)
+        return;
+
+    // the memory clobber makes sure timeVector is stored before it's loaded
+    asm __volatile__ (
+    ".set push      \n"
+    ".set reorder   \n"
+#if __GNUC__ > 3
+    "lqc2        $vf3, 0x00(%4)     \n"
+    "1:     \n"
+    "lqc2        $vf1, 0x00(%1)     \n"
+    "lqc2        $vf2, 0x00(%2)     \n"
+    "vsub.xyz    $vf2, $vf2, $vf1   \n"
+    "vmulx.xyz   $vf2, $vf2, $vf3x  \n"
+    "vadd.xyz    $vf1, $vf2, $vf1   \n"
+    "sqc2        $vf1, 0x00(%0)     \n"
+#else
+    "lqc2        vf3, 0x00(%4)      \n"
+    "1:                             \n"
+    "lqc2        vf1, 0x00(%1)      \n"
+    "lqc2        vf2, 0x00(%2)      \n"
+    "vsub.xyz    vf2, vf2, vf1      \n"
+    "vmulx.xyz   vf2, vf2, vf3x     \n"
+    "vadd.xyz    vf1, vf2, vf1      \n"
+    "sqc2        vf1, 0x00(%0)      \n"
+#endif
+    "addiu       %0, %0, 0x10       \n"
+    "addiu       %1, %1, 0x10       \n"
+    "addiu       %2, %2, 0x10       \n"
+    "addiu       %3, %3, -1         \n"
+    "bgtz        %3, 1b             \n"
+    ".set pop       \n"
+    : "+r" (output), "+r" (input0), "+r" (input1), "+r" (count)
+    : "r" (timeVector)
+    : "memory"
+    );
+}
+
+//--------------------------------------------------------
+void vector_sqrdist_batch(float * output, VECTOR * input, int count, VECTOR point)
+{
+    VECTOR t;
+    u32 result;
+
+    if (count <= 0)
+        return;
+
+    asm __volatile__ (
+    ".set push      \n"
+    ".set reorder   \n"
+#if __GNUC__ > 3
+    "vmaxw.xyzw     $vf3, $vf0, $vf0w   \n"
+    "lqc2		    $vf1, 0x00(%5)	    \n"
+    "1:     \n"
+    "lqc2		    $vf2, 0x00(%1)	    \n"
+    "vsub.xyz       $vf2, $vf2, $vf1    \n"
+    "vmul.xyz		$vf2, $vf2, $vf2    \n"
+    "vadday.x       $ACC, $vf2, $vf2y   \n"
+    "vmaddz.x		$vf2, $vf3, $vf2z   \n"
+    "sqc2		    $vf2, 0x00(%4)	    \n"
+#else
+    "vmaxw.xyzw     vf3, vf0, vf0w      \n"
+    "lqc2		    vf1, 0x00(%5)	    \n"
+    "1:                                 \n"
+    "lqc2		    vf2, 0x00(%1)	    \n"
+    "vsub.xyz       vf2, vf2, vf1       \n"
+    "vmul.xyz		vf2, vf2, vf2       \n"
+    "vadday.x       ACC, vf2, vf2y      \n"
+    "vmaddz.x		vf2, vf3, vf2z      \n"
+    "sqc2		    vf2, 0x00(%4)	    \n"
+#endif
+    "lw             %3, 0x00(%4)        \n"
+    "sw             %3, 0x00(%0)        \n"
+    "addiu          %0, %0, 4           \n"
+    "addiu          %1, %1, 0x10        \n"
+    "addiu          %2, %2, -1          \n"
+    "bgtz           %2, 1b              \n"
+    ".set pop       \n"
+    : "+r" (output), "+r" (input), "+r" (count), "=&r" (result)
+    : "r" (t), "r" (point)
+    : "memory"
+    );
+}
+
+//--------------------------------------------------------
+void vector_normalize_batch(VECTOR * output, VECTOR * input, int count)
+{
+    if (count <= 0)
+        return;
+
+    asm __volatile__ (
+    ".set push      \n"
+    ".set reorder   \n"
+    "1:     \n"
+#if __GNUC__ > 3
+    "lqc2   $vf1, 0x00(%1)  \n"
+    "vmul.xyz   $vf2, $vf1, $vf1  \n"
+    "vmulax.w   $ACC, $vf0, $vf2  \n"
+    "vmadday.w    $ACC, $vf0, $vf2  \n"
+    "vmaddz.w   $vf2, $vf0, $vf2  \n"
+    "vrsqrt   $Q, $vf0w, $vf2w  \n"
+    "vsub.w   $vf1, $vf0, $vf0  \n"
+    "vwaitq       \n"
+    "vmulq.xyz    $vf1, $vf1, $Q  \n"
+    "sqc2   $vf1, 0x00(%0)  \n"
+#else
+    "lqc2		vf1, 0x00(%1)	\n"
+    "vmul.xyz		vf2, vf1, vf1	\n"
+    "vmulax.w		ACC, vf0, vf2	\n"
+    "vmadday.w		ACC, vf0, vf2	\n"
+    "vmaddz.w		vf2, vf0, vf2	\n"
+    "vrsqrt		Q, vf0w, vf2w	\n"
+    "vsub.w		vf1, vf0, vf0	\n"
+    "vwaitq				\n"
+    "vmulq.xyz		vf1, vf1, Q	\n"
+    "sqc2		vf1, 0x00(%0)	\n"
+#endif
+    "addiu  %0, %0, 0x10    \n"
+    "addiu  %1, %1, 0x10    \n"
+    "addiu  %2, %2, -1      \n"
+    "bgtz   %2, 1b          \n"
+    ".set pop       \n"
+    : "+r" (output), "+r" (input), "+r" (count)
+    :
+    : "memory"
+    );
+}
+
+//--------------------------------------------------------
+#define VECTOR_BATCH_BENCH_COUNT        (1024)
+
+static VECTOR BenchVectors[VECTOR_BATCH_BENCH_COUNT];
+
+int vector_batch_selftest(void)
+{
+    int i;
+    VECTOR a[8], b[8], out[8], ref[8];
+    float dist[8], distRef[8];
+    MATRIX m;
+    int pass = 1;
+
+    for (i = 0; i < 8; ++i) {
+        a[i][0] = i * 1.5 - 4;
+        a[i][1] = 7 - i;
+        a[i][2] = i * 0.25 + 1;
+        a[i][3] = 1;
+        b[i][0] = 3 - i;
+        b[i][1] = i * 2.5;
+        b[i][2] = -i - 0.5;
+        b[i][3] = 1;
+    }
+    for (i = 0; i < 16; ++i)
+        m[i] = (i % 5) ? (i * 0.5 - 2) : 1;
+
+    vector_apply_batch(out, a, 8, m);
+    vector_apply_batch_ref(ref, a, 8, m);
+    pass &= vector_batch_compare("vector_apply_batch", (float*)out, (float*)ref, 8 * 4);
+
+    vector_lerp_batch(out, a, b, 8, 0.3);
+    vector_lerp_batch_ref(ref, a, b, 8, 0.3);
+    pass &= vector_batch_compare("vector_lerp_batch", (float*)out, (float*)ref, 8 * 4);
+
+    vector_sqrdist_batch(dist, a, 8, b[3]);
+    vector_sqrdist_batch_ref(distRef, a, 8, b[3]);
+    pass &= vector_batch_compare("vector_sqrdist_batch", dist, distRef, 8);
+
+    vector_normalize_batch(out, b, 8);
+    vector_normalize_batch_ref(ref, b, 8);
+    pass &= vector_batch_compare("vector_normalize_batch", (float*)out, (float*)ref, 8 * 4);
+
+    printf("vu0 batch selftest %s\n", pass ? "passed" : "FAILED");
+
+    // throughput against one call per vector and the c reference
+    for (i = 0; i < VECTOR_BATCH_BENCH_COUNT; ++i) {
+        BenchVectors[i][0] = i;
+        BenchVectors[i][1] = -i * 0.5;
+        BenchVectors[i][2] = 3;
+        BenchVectors[i][3] = 1;
+    }
+
+    long start = timerGetSystemTime();
+    vector_apply_batch(BenchVectors, BenchVectors, VECTOR_BATCH_BENCH_COUNT, m);
+    long batchTicks = timerGetSystemTime() - start;
+
+    start = timerGetSystemTime();
+    for (i = 0; i < VECTOR_BATCH_BENCH_COUNT; ++i)
+        vector_apply(BenchVectors[i], BenchVectors[i], m);
+    long singleTicks = timerGetSystemTime() - start;
+
+    start = timerGetSystemTime();
+    vector_apply_batch_ref(BenchVectors, BenchVectors, VECTOR_BATCH_BENCH_COUNT, m);
+    long refTicks = timerGetSystemTime() - start;
+
+    printf("vector_apply x%d: batch %ld ticks, single %ld ticks, c %ld ticks\n", VECTOR_BATCH_BENCH_COUNT, batchTicks, singleTicks, refTicks);
+    return pass;
+}
+
 //--------------------------------------------------------
 void matrix_toeuler(VECTOR output, MATRIX input0)
 {
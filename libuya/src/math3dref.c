@@ -0,0 +1,84 @@
+// plain c versions of the vu0 batched kernels in math3d.c
+// shared with misc/math3dtest.c, so this file must not depend on the rest of libuya
+#ifdef MATH3D_HOST
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#else
+#include "string.h"
+#include "math.h"
+#include "stdio.h"
+#endif
+#include "math3d.h"
+
+//--------------------------------------------------------
+void vector_apply_batch_ref(VECTOR * output, VECTOR * input, int count, MATRIX matrix)
+{
+    int i;
+    VECTOR r;
+
+    for (i = 0; i < count; ++i) {
+        r[0] = matrix[0] * input[i][0] + matrix[4] * input[i][1] + matrix[8] * input[i][2] + matrix[12];
+        r[1] = matrix[1] * input[i][0] + matrix[5] * input[i][1] + matrix[9] * input[i][2] + matrix[13];
+        r[2] = matrix[2] * input[i][0] + matrix[6] * input[i][1] + matrix[10] * input[i][2] + matrix[14];
+        r[3] = matrix[3] * input[i][0] + matrix[7] * input[i][1] + matrix[11] * input[i][2] + matrix[15];
+        memcpy(output[i], r, sizeof(VECTOR));
+    }
+}
+
+//--------------------------------------------------------
+void vector_lerp_batch_ref(VECTOR * output, VECTOR * input0, VECTOR * input1, int count, float t)
+{
+    int i, j;
+
+    for (i = 0; i < count; ++i) {
+        float w = input0[i][3];
+        for (j = 0; j < 3; ++j)
+            output[i][j] = input0[i][j] + (input1[i][j] - input0[i][j]) * t;
+        output[i][3] = w;
+    }
+}
+
+//--------------------------------------------------------
+void vector_sqrdist_batch_ref(float * output, VECTOR * input, int count, VECTOR point)
+{
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        float dx = input[i][0] - point[0];
+        float dy = input[i][1] - point[1];
+        float dz = input[i][2] - point[2];
+        output[i] = dx*dx + dy*dy + dz*dz;
+    }
+}
+
+//--------------------------------------------------------
+void vector_normalize_batch_ref(VECTOR * output, VECTOR * input, int count)
+{
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        float x = input[i][0], y = input[i][1], z = input[i][2];
+        float inv = 1.0 / sqrtf(x*x + y*y + z*z);
+        output[i][0] = x * inv;
+        output[i][1] = y * inv;
+        output[i][2] = z * inv;
+        output[i][3] = 0;
+    }
+}
+
+//--------------------------------------------------------
+int vector_batch_compare(const char * name, float * a, float * b, int count)
+{
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        float tolerance = 0.001 * (fabsf(b[i]) > 1 ? fabsf(b[i]) : 1);
+        if (fabsf(a[i] - b[i]) > tolerance) {
+            printf("%s: element %d is %f, reference %f\n", name, i, a[i], b[i]);
+            return 0;
+        }
+    }
+
+    return 1;
+}
@@ -1,16 +1,85 @@
 #include "moby.h"
 #include "interop.h"
 #include "guber.h"
+#include "game.h"
+#include "string.h"
 
 //--------------------------------------------------------
 #define BEGIN_MOBY_PTR							((Moby**)GetAddressImmediate(&vaBEGIN_MOBY_PTR))
 #define END_MOBY_PTR							((Moby**)((u32)GetAddressImmediate(&vaBEGIN_MOBY_PTR) + 0x8))
 #define MOBY_VARS_LIST_TOP_PTR					((Moby**)((u32)GetAddressImmediate(&vaBEGIN_MOBY_PTR) + 0x1b0))
 
+// Sizes of the open addressed lookup tables, must be powers of two.
+// Tables are only filled to 3/4, past that lookups fall back to a linear scan.
+#define MOBY_UID_INDEX_SIZE                     (2048)
+#define MOBY_GUBER_INDEX_SIZE                   (256)
+
+// Max mobys grouped by the oclass index, and number of distinct oclasses it can hold.
+// Mobys past either limit are scanned linearly by the iterator.
+#define MOBY_CLASS_INDEX_MAX_MOBYS              (2048)
+#define MOBY_CLASS_INDEX_SIZE                   (256)
+
+// Pooled mobys are parked here while hidden so they can't be collided with.
+#define MOBY_POOL_HIDE_HEIGHT                   (-10000)
+
 // For Orxon x12.
 // Not needed anymore, but keeping just so I still have record of it.
 #define MOBY_CLASS_LOADED_ADDR                  ((u16*)0x0026e7b0)
 
+typedef int (*MobyIndexGetKey_func)(Moby * moby, u32 * key);
+
+typedef struct MobyHashIndex
+{
+    u32 * Keys;
+    u16 * Slots;                    // moby list index + 1, 0 when empty
+    int Size;
+    int Complete;                   // every keyed moby fit in the table
+    int BuiltFrame;
+    Moby * ListStart;
+    MobyIndexGetKey_func GetKey;
+} MobyHashIndex_t;
+
+int mobyUidIndexGetKey(Moby * moby, u32 * key);
+int mobyGuberIndexGetKey(Moby * moby, u32 * key);
+
+u32 mobyUidIndexKeys[MOBY_UID_INDEX_SIZE];
+u16 mobyUidIndexSlots[MOBY_UID_INDEX_SIZE];
+u32 mobyGuberIndexKeys[MOBY_GUBER_INDEX_SIZE];
+u16 mobyGuberIndexSlots[MOBY_GUBER_INDEX_SIZE];
+
+MobyHashIndex_t mobyUidIndex = {
+    .Keys = mobyUidIndexKeys,
+    .Slots = mobyUidIndexSlots,
+    .Size = MOBY_UID_INDEX_SIZE,
+    .BuiltFrame = -1,
+    .GetKey = &mobyUidIndexGetKey,
+};
+
+MobyHashIndex_t mobyGuberIndex = {
+    .Keys = mobyGuberIndexKeys,
+    .Slots = mobyGuberIndexSlots,
+    .Size = MOBY_GUBER_INDEX_SIZE,
+    .BuiltFrame = -1,
+    .GetKey = &mobyGuberIndexGetKey,
+};
+
+typedef struct MobyClassIndex
+{
+    Moby * ListStart;
+    Moby * BuiltEnd;                // mobys from here on aren't indexed
+    int TimeStart;                  // game the index was built for
+    int Invalidated;
+    u8 Used[MOBY_CLASS_INDEX_SIZE];
+    u16 Classes[MOBY_CLASS_INDEX_SIZE];
+    u16 Start[MOBY_CLASS_INDEX_SIZE];
+    u16 Count[MOBY_CLASS_INDEX_SIZE];
+    u16 Entries[MOBY_CLASS_INDEX_MAX_MOBYS];
+} MobyClassIndex_t;
+
+MobyClassIndex_t mobyClassIndex = {
+    .Invalidated = 1,
+};
+
 VariableAddress_t vaBEGIN_MOBY_PTR = {
 #if UYA_PAL
 	.Lobby = 0,
@@ -211,11 +280,116 @@ int mobyIsDestroyed(Moby* moby)
 //     return *(int*)0x00222790;
 // }
 
+//--------------------------------------------------------
+int mobyUidIndexGetKey(Moby * moby, u32 * key)
+{
+  if (moby->UID < 0)
+    return 0;
+
+  *key = (u32)moby->UID;
+  return 1;
+}
+
+//--------------------------------------------------------
+int mobyGuberIndexGetKey(Moby * moby, u32 * key)
+{
+  Guber* guber = guberGetObjectByMoby(moby);
+  if (!guber)
+    return 0;
+
+  *key = guber->Id.UID;
+  return 1;
+}
+
+//--------------------------------------------------------
+u32 mobyHashIndexHash(MobyHashIndex_t * index, u32 key)
+{
+  // fibonacci hashing, keeps sequential uids spread out
+  return ((key * 0x9E3779B1) >> 16) & (index->Size - 1);
+}
+
 /*
- * Returns a pointer to the moby with the given uid.
- * Returns NULL if none found.
+ * Rebuilds the index from the moby list.
+ * Only rebuilds once per frame unless the moby list has moved.
+ * Returns non-zero if the index was rebuilt.
  */
-Moby* mobyFindByUID(int uid)
+int mobyHashIndexRebuild(MobyHashIndex_t * index)
+{
+  Moby* mStart = mobyListGetStart();
+  Moby* mEnd = mobyListGetEnd();
+  Moby* moby = mStart;
+  int frame = gameGetGSFrame();
+  int limit = (index->Size * 3) / 4;
+  int count = 0;
+  u32 key, h;
+
+  if (index->BuiltFrame == frame && index->ListStart == mStart)
+    return 0;
+
+  memset(index->Slots, 0, sizeof(u16) * index->Size);
+  index->BuiltFrame = frame;
+  index->ListStart = mStart;
+  index->Complete = 1;
+
+  while (moby < mEnd)
+  {
+    if (index->GetKey(moby, &key))
+    {
+      if (count >= limit)
+      {
+        index->Complete = 0;
+        break;
+      }
+
+      // linear probe to first empty slot
+      h = mobyHashIndexHash(index, key);
+      while (index->Slots[h])
+        h = (h + 1) & (index->Size - 1);
+
+      index->Keys[h] = key;
+      index->Slots[h] = (u16)((moby - mStart) + 1);
+      ++count;
+    }
+
+    ++moby;
+  }
+
+  return 1;
+}
+
+/*
+ * Returns the moby stored under the given key.
+ * The result may be stale and must be validated by the caller.
+ */
+Moby* mobyHashIndexFind(MobyHashIndex_t * index, u32 key)
+{
+  Moby* mStart = mobyListGetStart();
+  Moby* moby;
+  u32 h;
+
+  if (index->ListStart != mStart)
+    return NULL;
+
+  h = mobyHashIndexHash(index, key);
+  while (index->Slots[h])
+  {
+    if (index->Keys[h] == key)
+    {
+      moby = mStart + (index->Slots[h] - 1);
+      if (moby < mobyListGetEnd())
+        return moby;
+
+      return NULL;
+    }
+
+    h = (h + 1) & (index->Size - 1);
+  }
+
+  return NULL;
+}
+
+//--------------------------------------------------------
+Moby* mobyFindByUIDLinear(int uid)
 {
   Moby* mStart = mobyListGetStart();
   Moby* mEnd = mobyListGetEnd();
@@ -230,6 +404,37 @@ Moby* mobyFindByUID(int uid)
   return NULL;
 }
 
+/*
+ * Returns a pointer to the moby with the given uid.
+ * Returns NULL if none found.
+ */
+Moby* mobyFindByUID(int uid)
+{
+  Moby* moby;
+
+  if (uid < 0)
+    return mobyFindByUIDLinear(uid);
+
+  moby = mobyHashIndexFind(&mobyUidIndex, (u32)uid);
+  if (moby && moby->UID == uid)
+    return moby;
+
+  // index is stale, rebuild and try again
+  if (mobyHashIndexRebuild(&mobyUidIndex))
+  {
+    moby = mobyHashIndexFind(&mobyUidIndex, (u32)uid);
+    if (moby && moby->UID == uid)
+      return moby;
+
+    // a complete index built just now has seen every moby
+    if (mobyUidIndex.Complete)
+      return NULL;
+  }
+
+  // built earlier this frame, the moby may have spawned or moved since
+  return mobyFindByUIDLinear(uid);
+}
+
 /*
  * Returns a pointer to the next living moby of the given oclass.
  * Returns NULL if none found.
@@ -252,6 +457,175 @@ Moby * mobyFindNextByOClass(Moby* start, int oClass)
     return NULL;
 }
 
+//--------------------------------------------------------
+int mobyClassIndexFindSlot(int oClass, int insert)
+{
+  u32 h = (((u32)oClass * 0x9E3779B1) >> 16) & (MOBY_CLASS_INDEX_SIZE - 1);
+
+  // oclass 0 is a valid class so occupancy is tracked separately
+  while (mobyClassIndex.Used[h])
+  {
+    if (mobyClassIndex.Classes[h] == (u16)oClass)
+      return h;
+
+    h = (h + 1) & (MOBY_CLASS_INDEX_SIZE - 1);
+  }
+
+  if (!insert)
+    return -1;
+
+  mobyClassIndex.Used[h] = 1;
+  mobyClassIndex.Classes[h] = (u16)oClass;
+  return h;
+}
+
+/*
+ * Groups the living mobys in the moby list by oclass.
+ */
+void mobyClassIndexRebuild(void)
+{
+  Moby* mStart = mobyListGetStart();
+  Moby* mEnd = mobyListGetEnd();
+  Moby* moby;
+  int limit = (MOBY_CLASS_INDEX_SIZE * 3) / 4;
+  int classCount = 0;
+  int i, slot, offset;
+
+  memset(mobyClassIndex.Used, 0, sizeof(mobyClassIndex.Used));
+  memset(mobyClassIndex.Count, 0, sizeof(mobyClassIndex.Count));
+  mobyClassIndex.ListStart = mStart;
+  mobyClassIndex.TimeStart = gameGetData()->timeStart;
+  mobyClassIndex.Invalidated = 0;
+
+  if (mEnd - mStart > MOBY_CLASS_INDEX_MAX_MOBYS)
+    mEnd = mStart + MOBY_CLASS_INDEX_MAX_MOBYS;
+
+  // count mobys per class
+  for (moby = mStart; moby < mEnd; ++moby)
+  {
+    if (mobyIsDestroyed(moby))
+      continue;
+
+    slot = mobyClassIndexFindSlot(moby->oClass, 0);
+    if (slot < 0)
+    {
+      // out of class slots, leave the rest to the linear tail
+      if (classCount >= limit)
+        break;
+
+      slot = mobyClassIndexFindSlot(moby->oClass, 1);
+      ++classCount;
+    }
+
+    ++mobyClassIndex.Count[slot];
+  }
+  mobyClassIndex.BuiltEnd = moby;
+
+  // assign each class a contiguous range of entries
+  for (i = 0, offset = 0; i < MOBY_CLASS_INDEX_SIZE; ++i)
+  {
+    mobyClassIndex.Start[i] = offset;
+    offset += mobyClassIndex.Count[i];
+  }
+
+  // fill, using Start as the write cursor
+  for (moby = mStart; moby < mobyClassIndex.BuiltEnd; ++moby)
+  {
+    if (mobyIsDestroyed(moby))
+      continue;
+
+    slot = mobyClassIndexFindSlot(moby->oClass, 0);
+    mobyClassIndex.Entries[mobyClassIndex.Start[slot]++] = (u16)(moby - mStart);
+  }
+
+  // rewind the cursors
+  for (i = 0; i < MOBY_CLASS_INDEX_SIZE; ++i)
+    mobyClassIndex.Start[i] -= mobyClassIndex.Count[i];
+}
+
+//--------------------------------------------------------
+void mobyClassIndexInvalidate(void)
+{
+  mobyClassIndex.Invalidated = 1;
+}
+
+//--------------------------------------------------------
+Moby * mobyClassIterBegin(MobyClassIterator_t * it, int oClass)
+{
+  Moby* mStart = mobyListGetStart();
+  int slot;
+
+  memset(it, 0, sizeof(MobyClassIterator_t));
+  it->OClass = oClass;
+
+  // no level to index, scan everything
+  // and rebuild once the next level has loaded
+  if (!isInGame())
+  {
+    mobyClassIndex.Invalidated = 1;
+    it->Tail = mStart;
+    return mobyClassIterNext(it);
+  }
+
+  // rebuild after level load or when the list has been compacted
+  if (mobyClassIndex.Invalidated
+    || mobyClassIndex.TimeStart != gameGetData()->timeStart
+    || mobyClassIndex.ListStart != mStart
+    || mobyListGetEnd() < mobyClassIndex.BuiltEnd)
+    mobyClassIndexRebuild();
+
+  slot = mobyClassIndexFindSlot(oClass, 0);
+  if (slot >= 0)
+  {
+    it->Entry = mobyClassIndex.Start[slot];
+    it->EntryEnd = it->Entry + mobyClassIndex.Count[slot];
+  }
+
+  // mobys spawned since the last rebuild
+  it->Tail = mobyClassIndex.BuiltEnd;
+  return mobyClassIterNext(it);
+}
+
+//--------------------------------------------------------
+Moby * mobyClassIterNext(MobyClassIterator_t * it)
+{
+  Moby* mStart = mobyListGetStart();
+  Moby* mEnd = mobyListGetEnd();
+  Moby* moby;
+
+  while (it->Entry < it->EntryEnd)
+  {
+    moby = mStart + mobyClassIndex.Entries[it->Entry++];
+    if (moby < mEnd && moby->oClass == it->OClass && !mobyIsDestroyed(moby))
+      return moby;
+  }
+
+  while (it->Tail && it->Tail < mEnd)
+  {
+    moby = it->Tail++;
+    if (moby->oClass == it->OClass && !mobyIsDestroyed(moby))
+      return moby;
+  }
+
+  return NULL;
+}
+
+//--------------------------------------------------------
+int mobyClassCount(int oClass)
+{
+  MobyClassIterator_t it;
+  int count = 0;
+  Moby* moby = mobyClassIterBegin(&it, oClass);
+
+  while (moby)
+  {
+    ++count;
+    moby = mobyClassIterNext(&it);
+  }
+
+  return count;
+}
+
 /*
  * Returns non-zero if the given o class is loaded in the map.
  */
@@ -268,9 +642,8 @@ int mobyClassIsLoaded(int oClass)
     return 0;
 }
 
-/*
- */
-Moby* mobyGetByGuberUid(u32 uid)
+//--------------------------------------------------------
+Moby* mobyGetByGuberUidLinear(u32 uid)
 {
   Moby* mEnd = mobyListGetEnd();
   Moby* m = mobyListGetStart();
@@ -287,6 +660,35 @@ Moby* mobyGetByGuberUid(u32 uid)
   return NULL;
 }
 
+/*
+ * Returns a pointer to the moby owned by the guber with the given uid.
+ * Returns NULL if none found.
+ */
+Moby* mobyGetByGuberUid(u32 uid)
+{
+  Moby* moby;
+  Guber* guber;
+
+  moby = mobyHashIndexFind(&mobyGuberIndex, uid);
+  if (moby && (guber = guberGetObjectByMoby(moby)) && guber->Id.UID == uid)
+    return moby;
+
+  // index is stale, rebuild and try again
+  if (mobyHashIndexRebuild(&mobyGuberIndex))
+  {
+    moby = mobyHashIndexFind(&mobyGuberIndex, uid);
+    if (moby && (guber = guberGetObjectByMoby(moby)) && guber->Id.UID == uid)
+      return moby;
+
+    // a complete index built just now has seen every moby
+    if (mobyGuberIndex.Complete)
+      return NULL;
+  }
+
+  // built earlier this frame, the moby may have spawned or moved since
+  return mobyGetByGuberUidLinear(uid);
+}
+
 VariableAddress_t vaShieldTriggerVars = {
 #if UYA_PAL
 	.Lobby = 0,
@@ -334,6 +736,182 @@ void mobySetState(Moby *this, char state, char stateType)
     }
 }
 
+//--------------------------------------------------------
+int mobyPoolIsValid(MobyPool_t * pool, Moby * moby)
+{
+    return moby && moby->oClass == pool->OClass && !mobyIsDestroyed(moby);
+}
+
+//--------------------------------------------------------
+void mobyPoolHide(Moby * moby)
+{
+    moby->pUpdate = NULL;
+    moby->drawn = 0;
+    moby->alpha = 0;
+    moby->position[2] = MOBY_POOL_HIDE_HEIGHT;
+}
+
+//--------------------------------------------------------
+Moby * mobyPoolSpawn(MobyPool_t * pool)
+{
+    Moby * moby = mobySpawn(pool->OClass, pool->PropSize);
+    if (moby)
+    {
+        mobyPoolHide(moby);
+
+        // may have landed in a recycled slot
+        mobyClassIndexInvalidate();
+    }
+
+    return moby;
+}
+
+//--------------------------------------------------------
+void mobyPoolInit(MobyPool_t * pool, Moby ** storage, int capacity, int oClass, int propSize)
+{
+    memset(pool, 0, sizeof(MobyPool_t));
+    memset(storage, 0, sizeof(Moby*) * capacity);
+    pool->Mobies = storage;
+    pool->Capacity = capacity;
+    pool->OClass = oClass;
+    pool->PropSize = propSize;
+}
+
+//--------------------------------------------------------
+int mobyPoolReserve(MobyPool_t * pool, int count)
+{
+    if (count > pool->Capacity)
+        count = pool->Capacity;
+
+    while (pool->Count < count)
+    {
+        Moby * moby = mobyPoolSpawn(pool);
+        if (!moby)
+            break;
+
+        pool->Mobies[pool->Count++] = moby;
+    }
+
+    return pool->Count;
+}
+
+//--------------------------------------------------------
+Moby * mobyPoolAcquire(MobyPool_t * pool, VECTOR position)
+{
+    Moby * moby = NULL;
+
+    if (pool->Active < pool->Count)
+    {
+        // replace free mobys the game has since destroyed
+        moby = pool->Mobies[pool->Active];
+        if (!mobyPoolIsValid(pool, moby))
+            pool->Mobies[pool->Active] = moby = mobyPoolSpawn(pool);
+    }
+    else if (pool->Count < pool->Capacity)
+    {
+        moby = mobyPoolSpawn(pool);
+        if (moby)
+            pool->Mobies[pool->Count++] = moby;
+    }
+
+    if (!moby)
+        return NULL;
+
+    ++pool->Active;
+    vector_copy(moby->position, position);
+    moby->drawn = 1;
+    moby->alpha = 0x80;
+    return moby;
+}
+
+//--------------------------------------------------------
+void mobyPoolRelease(MobyPool_t * pool, Moby * moby)
+{
+    int i;
+
+    for (i = 0; i < pool->Active; ++i)
+    {
+        if (pool->Mobies[i] == moby)
+        {
+            // swap with last in use entry to keep [0, Active) packed
+            --pool->Active;
+            pool->Mobies[i] = pool->Mobies[pool->Active];
+            pool->Mobies[pool->Active] = moby;
+
+            if (mobyPoolIsValid(pool, moby))
+                mobyPoolHide(moby);
+            return;
+        }
+    }
+}
+
+//--------------------------------------------------------
+void mobyPoolDiscard(MobyPool_t * pool, Moby * moby)
+{
+    int i;
+
+    mobyPoolRelease(pool, moby);
+
+    // free entries are [Active, Count)
+    for (i = pool->Active; i < pool->Count; ++i)
+    {
+        if (pool->Mobies[i] == moby)
+        {
+            --pool->Count;
+            pool->Mobies[i] = pool->Mobies[pool->Count];
+            pool->Mobies[pool->Count] = NULL;
+
+            if (mobyPoolIsValid(pool, moby))
+                mobyDestroy(moby);
+            return;
+        }
+    }
+}
+
+//--------------------------------------------------------
+void mobyPoolReleaseAll(MobyPool_t * pool)
+{
+    int i;
+
+    // level has unloaded, nothing left to hide
+    if (!isInGame())
+    {
+        memset(pool->Mobies, 0, sizeof(Moby*) * pool->Capacity);
+        pool->Count = 0;
+        pool->Active = 0;
+        return;
+    }
+
+    for (i = 0; i < pool->Active; ++i)
+    {
+        Moby * moby = pool->Mobies[i];
+        if (mobyPoolIsValid(pool, moby))
+            mobyPoolHide(moby);
+    }
+
+    pool->Active = 0;
+}
+
+//--------------------------------------------------------
+void mobyPoolDestroy(MobyPool_t * pool)
+{
+    int i;
+
+    if (isInGame())
+    {
+        for (i = 0; i < pool->Count; ++i)
+        {
+            Moby * moby = pool->Mobies[i];
+            if (mobyPoolIsValid(pool, moby))
+                mobyDestroy(moby);
+        }
+    }
+
+    memset(pool->Mobies, 0, sizeof(Moby*) * pool->Capacity);
+    pool->Count = 0;
+    pool->Active = 0;
+}
+
 VariableAddress_t vaFlagUpdate_Func = {
 #if UYA_PAL
     .Lobby = 0,
@@ -28,6 +28,7 @@ int internal_netSendMessage(int transport, void * connection, long clientIndex,
 int internal_netSendAppMessage(int transport, void * connection, long clientIndex, int msgId, int msgSize, void * payload);
 
 NET_CALLBACK_DELEGATE callbacks[256] = {};
+NET_RECORD_DELEGATE recordCallback = NULL;
 
 int customMsgHandler(void * connection, u64 a1, u64 a2, u8 * data)
 {
@@ -35,8 +36,13 @@ int customMsgHandler(void * connection, u64 a1, u64 a2, u8 * data)
 
 
     NET_CALLBACK_DELEGATE callback = NET_GLOBAL_CALLBACKS_PTR[id];
-    if (callback)
-        return 4 + callback(connection, (void*)(data + 4));
+    if (callback) {
+        int size = callback(connection, (void*)(data + 4));
+        if (recordCallback)
+            recordCallback(NET_RECORD_RECV, -1, id, size, (void*)(data + 4));
+
+        return 4 + size;
+    }
     else
         printf("unhandled custom message id:%d\n", id);
 
@@ -101,6 +107,9 @@ int netSendCustomAppMessage(void * connection, int clientIndex, u8 customMsgId,
         memcpy(buffer + 4, payload, msgSize);
         
     buffer[0] = customMsgId;
+    if (recordCallback)
+        recordCallback(NET_RECORD_SEND, clientIndex, customMsgId, msgSize, payload);
+
     return netSendMediusAppMessage(connection, clientIndex, NET_CUSTOM_MESSAGE_CLASS, NET_CUSTOM_MESSAGE_ID, msgSize + 4, buffer);
 }
 
@@ -114,9 +123,17 @@ int netBroadcastCustomAppMessage(void * connection, u8 customMsgId, int msgSize,
         memcpy(buffer + 4, payload, msgSize);
         
     buffer[0] = customMsgId;
+    if (recordCallback)
+        recordCallback(NET_RECORD_SEND, -1, customMsgId, msgSize, payload);
+
     return netBroadcastMediusAppMessage(connection, NET_CUSTOM_MESSAGE_ID, msgSize + 4, buffer);
 }
 
+void netSetRecordCallback(NET_RECORD_DELEGATE callback)
+{
+    recordCallback = callback;
+}
+
 void* netGetLobbyServerConnection(void)
 {
     return NET_LOBBY_CONNECTION;
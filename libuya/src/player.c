@@ -167,6 +167,9 @@ extern const PadHistory DefaultPadHistory;
 // Player pad history
 PadHistory PlayerPadHistory[GAME_MAX_PLAYERS];
 
+// Player roster, rebuilt once per frame
+PlayerRoster_t PlayerRoster = { .Frame = -1 };
+
 //--------------------------------------------------------------------------------
 Player ** playerGetAll(void)
 {
@@ -889,3 +892,82 @@ int playerIsLinkHealthy(Player *player)
 {
     return playerGetLatency(player) <= 150;
 }
+
+//--------------------------------------------------------------------------------
+void playerRosterBuild(PlayerRoster_t * roster)
+{
+    int i;
+    Player ** players = playerGetAll();
+    GameSettings * gs = gameGetSettings();
+
+    memset(roster->Players, 0, sizeof(roster->Players));
+    memset(roster->TeamMasks, 0, sizeof(roster->TeamMasks));
+    memset(roster->NameHash, 0, sizeof(roster->NameHash));
+    roster->PresentMask = 0;
+    roster->LocalMask = 0;
+    roster->AliveMask = 0;
+    roster->Count = 0;
+
+    if (!players)
+        return;
+
+    for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
+        Player * player = players[i];
+        if (!player)
+            continue;
+
+        u8 bit = 1 << i;
+        roster->Players[i] = player;
+        roster->PresentMask |= bit;
+        ++roster->Count;
+        vector_copy(roster->Positions[i], player->playerPosition);
+
+        if (player->isLocal)
+            roster->LocalMask |= bit;
+        if (playerGetHealth(player) > 0 && !playerIsDead(player))
+            roster->AliveMask |= bit;
+        if (player->mpTeam >= 0 && player->mpTeam < GAME_MAX_PLAYERS)
+            roster->TeamMasks[player->mpTeam] |= bit;
+
+        // insert name with linear probing
+        if (gs && gs->PlayerNames[i][0]) {
+            int slot = fnv1aString(gs->PlayerNames[i], PLAYER_ROSTER_NAME_LENGTH) % PLAYER_ROSTER_NAME_HASH_SIZE;
+            while (roster->NameHash[slot])
+                slot = (slot + 1) % PLAYER_ROSTER_NAME_HASH_SIZE;
+            roster->NameHash[slot] = i + 1;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------
+PlayerRoster_t * playerGetRoster(void)
+{
+    int frame = gameGetGSFrame();
+    if (PlayerRoster.Frame != frame) {
+        playerRosterBuild(&PlayerRoster);
+        PlayerRoster.Frame = frame;
+    }
+
+    return &PlayerRoster;
+}
+
+//--------------------------------------------------------------------------------
+int playerRosterFindByName(char * name)
+{
+    int i;
+    PlayerRoster_t * roster = playerGetRoster();
+    GameSettings * gs = gameGetSettings();
+    if (!gs || !name)
+        return -1;
+
+    int slot = fnv1aString(name, PLAYER_ROSTER_NAME_LENGTH) % PLAYER_ROSTER_NAME_HASH_SIZE;
+    for (i = 0; i < PLAYER_ROSTER_NAME_HASH_SIZE && roster->NameHash[slot]; ++i) {
+        int playerIdx = roster->NameHash[slot] - 1;
+        if (strncmp(name, gs->PlayerNames[playerIdx], PLAYER_ROSTER_NAME_LENGTH) == 0)
+            return playerIdx;
+
+        slot = (slot + 1) % PLAYER_ROSTER_NAME_HASH_SIZE;
+    }
+
+    return -1;
+}
@@ -1,5 +1,16 @@
 #include <tamtypes.h>
 #include "utils.h"
+#include "game.h"
+#include "alloc.h"
+
+// per frame bump allocator
+// buffer left zero initialized so it lands in .bss, Frame 0 starts with an empty arena anyway
+u8 FrameArenaBuffer[FRAME_ARENA_SIZE] __attribute__((aligned(16)));
+struct FrameArena
+{
+    AllocArena_t Arena;
+    int Frame;
+} FrameArena = { .Arena = { .Buffer = FrameArenaBuffer, .Size = FRAME_ARENA_SIZE } };
 
 //--------------------------------------------------------------------------------
 int isInEEMemory(void* p)
@@ -28,3 +39,55 @@ int ConvertJALtoAddress(int instruction)
 {
 	return ((instruction & 0x03FFFFFF) << 2);
 }
+
+//--------------------------------------------------------------------------------
+void * frameArenaAlloc(int size)
+{
+    int frame = gameGetGSFrame();
+    if (FrameArena.Frame != frame) {
+        FrameArena.Frame = frame;
+        allocArenaReset(&FrameArena.Arena);
+    }
+
+    return allocArenaGet(&FrameArena.Arena, size);
+}
+
+//--------------------------------------------------------------------------------
+int frameArenaGetFree(void)
+{
+    if (FrameArena.Frame != gameGetGSFrame())
+        return FrameArena.Arena.Size;
+
+    return FrameArena.Arena.Size - FrameArena.Arena.Offset;
+}
+
+//--------------------------------------------------------------------------------
+int frameArenaGetHighWaterMark(void)
+{
+    return FrameArena.Arena.Peak;
+}
+
+//--------------------------------------------------------------------------------
+u32 fnv1a(void * data, int size)
+{
+    int i;
+    u8 * bytes = (u8*)data;
+    u32 hash = FNV1A_OFFSET_BASIS;
+
+    for (i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * FNV1A_PRIME;
+
+    return hash;
+}
+
+//--------------------------------------------------------------------------------
+u32 fnv1aString(char * str, int maxLength)
+{
+    int i;
+    u32 hash = FNV1A_OFFSET_BASIS;
+
+    for (i = 0; i < maxLength && str[i]; ++i)
+        hash = (hash ^ (u8)str[i]) * FNV1A_PRIME;
+
+    return hash;
+}
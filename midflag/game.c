@@ -155,17 +155,9 @@ void patchFlagUiPopup(void)
 
 void midFlagGetFlags(void)
 {
-	Moby *mobyStart = mobyListGetStart();
-	Moby *mobyEnd = mobyListGetEnd();
-	while (mobyStart < mobyEnd) {
-		switch (mobyStart->oClass) {
-			case MOBY_ID_CTF_RED_FLAG:
-				midFlag.pRedFlag = mobyStart;
-			case MOBY_ID_CTF_BLUE_FLAG:
-				midFlag.pBlueFlag = mobyStart;
-		}
-		++mobyStart;
-	}
+	MobyClassIterator_t it;
+	midFlag.pRedFlag = mobyClassIterBegin(&it, MOBY_ID_CTF_RED_FLAG);
+	midFlag.pBlueFlag = mobyClassIterBegin(&it, MOBY_ID_CTF_BLUE_FLAG);
 	midFlag.setup = 1;
 }
 
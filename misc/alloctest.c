@@ -0,0 +1,331 @@
+/***************************************************
+ * FILENAME :		alloctest.c
+ * DESCRIPTION :
+ * 		Stress test and benchmark for libuya/src/alloc.c.
+ *    Runs random tagged allocations, pool blocks and arena
+ *    allocations against a shadow table, checking contents, per tag
+ *    stats, pool occupancy and poisoning. Then times pools and
+ *    tagged allocations against the libc allocator.
+ *
+ *    gcc -O2 -fsanitize=address,undefined -DALLOC_HOST -iquote ../libuya/include -o alloctest alloctest.c
+ *    ./alloctest [iterations] [seed]
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include "../libuya/src/alloc.c"
+
+#define LIVE_MAX                    (512)
+#define POOL_BLOCK_SIZE             (100) // rounded up to 112
+#define POOL_BLOCK_COUNT            (64)
+#define ARENA_SIZE                  (4096)
+#define BENCH_LIVE                  (256)
+#define BENCH_PREFETCH_BLOCK_SIZE   (64 * 1024) // MAP_PREFETCH_BLOCK_SIZE in patch/include/config.h
+
+typedef struct LiveAlloc
+{
+  u8 * Ptr;
+  int Size;
+  int Tag;
+  u8 Fill;
+} LiveAlloc_t;
+
+int Failures = 0;
+
+//--------------------------------------------------------------------------
+void fail(const char * test, const char * what, int value)
+{
+  printf("FAIL %s: %s (%d)\n", test, what, value);
+  ++Failures;
+}
+
+//--------------------------------------------------------------------------
+int checkFill(u8 * ptr, int size, u8 fill)
+{
+  int i;
+
+  for (i = 0; i < size; ++i)
+    if (ptr[i] != fill)
+      return 0;
+
+  return 1;
+}
+
+//--------------------------------------------------------------------------
+void testTagged(int iterations)
+{
+  LiveAlloc_t live[LIVE_MAX];
+  int liveCount = 0, i, tag;
+  int current[ALLOC_TAG_COUNT] = {0};
+  int allocs[ALLOC_TAG_COUNT] = {0};
+  int frees[ALLOC_TAG_COUNT] = {0};
+
+  memset(AllocTagStats, 0, sizeof(AllocTagStats));
+  for (i = 0; i < iterations && !Failures; ++i) {
+    if (liveCount < LIVE_MAX && (liveCount == 0 || rand() % 3)) {
+      LiveAlloc_t * a = &live[liveCount];
+      a->Size = rand() % 4 ? rand() % 256 : rand() % 65536;
+      a->Tag = rand() % ALLOC_TAG_COUNT;
+      a->Fill = rand();
+      a->Ptr = allocTagged(a->Tag, a->Size);
+      if (!a->Ptr) {
+        fail("tagged", "allocation failed", a->Size);
+        return;
+      }
+
+      // malloc alignment must survive the header
+      if ((uintptr_t)a->Ptr & 0xF)
+        fail("tagged", "allocation not 16 byte aligned", a->Size);
+
+      memset(a->Ptr, a->Fill, a->Size);
+      current[a->Tag] += a->Size;
+      allocs[a->Tag] += 1;
+      ++liveCount;
+    } else {
+      int idx = rand() % liveCount;
+      LiveAlloc_t * a = &live[idx];
+      if (!checkFill(a->Ptr, a->Size, a->Fill))
+        fail("tagged", "allocation overwritten", a->Size);
+
+      freeTagged(a->Ptr);
+      current[a->Tag] -= a->Size;
+      frees[a->Tag] += 1;
+      live[idx] = live[--liveCount];
+    }
+
+    for (tag = 0; tag < ALLOC_TAG_COUNT; ++tag) {
+      AllocTagStats_t * stats = allocGetTagStats(tag);
+      if (stats->Current != current[tag] || stats->Allocs != allocs[tag] || stats->Frees != frees[tag] || stats->Peak < stats->Current)
+        fail("tagged", "stats drifted on tag", tag);
+    }
+  }
+
+  while (liveCount > 0)
+    freeTagged(live[--liveCount].Ptr);
+
+  // bad tags are charged to default, bad sizes and foreign pointers are rejected
+  void * p = allocTagged(ALLOC_TAG_COUNT + 5, 16);
+  if (!p || AllocTagStats[ALLOC_TAG_DEFAULT].Current != 16)
+    fail("tagged", "out of range tag not charged to default", ALLOC_TAG_DEFAULT);
+  freeTagged(p);
+  if (allocTagged(ALLOC_TAG_NET, -1) != NULL || AllocTagStats[ALLOC_TAG_NET].Failed != 1)
+    fail("tagged", "negative size not rejected", -1);
+  if (allocGetTagStats(-1) || allocGetTagStats(ALLOC_TAG_COUNT))
+    fail("tagged", "out of range tag has stats", ALLOC_TAG_COUNT);
+
+  u8 * foreign = malloc(64);
+  memset(foreign, 0, 64);
+  freeTagged(foreign + 16);
+  free(foreign);
+}
+
+//--------------------------------------------------------------------------
+void testPool(int iterations)
+{
+  AllocPool_t pool;
+  u8 * live[POOL_BLOCK_COUNT];
+  u8 fills[POOL_BLOCK_COUNT];
+  int liveCount = 0, peak = 0, i, j;
+
+  if (!allocPoolInit(&pool, ALLOC_TAG_PATCH, POOL_BLOCK_SIZE, POOL_BLOCK_COUNT)) {
+    fail("pool", "init failed", POOL_BLOCK_COUNT);
+    return;
+  }
+
+  if (pool.BlockSize != 112 || AllocTagStats[ALLOC_TAG_PATCH].Current != 112 * POOL_BLOCK_COUNT)
+    fail("pool", "block size not rounded to 16", pool.BlockSize);
+
+  for (i = 0; i < iterations && !Failures; ++i) {
+    if (rand() % 2) {
+      u8 * block = allocPoolGet(&pool);
+      if (liveCount == POOL_BLOCK_COUNT) {
+        if (block)
+          fail("pool", "handed out a block past capacity", liveCount);
+        continue;
+      }
+
+      if (!block) {
+        fail("pool", "empty with free blocks", liveCount);
+        return;
+      }
+
+      if ((block - pool.Buffer) % pool.BlockSize || ((uintptr_t)block & 0xF))
+        fail("pool", "misaligned block", (int)(block - pool.Buffer));
+      for (j = 0; j < liveCount; ++j)
+        if (live[j] == block)
+          fail("pool", "block handed out twice", j);
+
+      fills[liveCount] = rand();
+      memset(block, fills[liveCount], pool.BlockSize);
+      live[liveCount++] = block;
+      if (liveCount > peak)
+        peak = liveCount;
+    } else if (liveCount > 0) {
+      int idx = rand() % liveCount;
+      if (!checkFill(live[idx], pool.BlockSize, fills[idx]))
+        fail("pool", "block overwritten", idx);
+
+      allocPoolPut(&pool, live[idx]);
+
+      // everything past the free list link is poisoned
+      if (AllocPoison && !checkFill(live[idx] + sizeof(void*), pool.BlockSize - sizeof(void*), ALLOC_POISON_BYTE))
+        fail("pool", "freed block not poisoned", idx);
+
+      --liveCount;
+      live[idx] = live[liveCount];
+      fills[idx] = fills[liveCount];
+    }
+
+    if (pool.Used != liveCount || pool.Peak != peak)
+      fail("pool", "occupancy drifted", pool.Used);
+  }
+
+  // pointers that aren't blocks are ignored
+  allocPoolPut(&pool, pool.Buffer + 8);
+  allocPoolPut(&pool, pool.Buffer + pool.BlockSize * pool.BlockCount);
+  allocPoolPut(&pool, NULL);
+  if (pool.Used != liveCount)
+    fail("pool", "foreign pointer accepted", pool.Used);
+
+  allocPoolDestroy(&pool);
+  if (AllocTagStats[ALLOC_TAG_PATCH].Current != 0)
+    fail("pool", "destroy leaked", AllocTagStats[ALLOC_TAG_PATCH].Current);
+
+  if (allocPoolInit(&pool, ALLOC_TAG_PATCH, 0, 4) || allocPoolGet(&pool) != NULL)
+    fail("pool", "empty pool handed out a block", 0);
+}
+
+//--------------------------------------------------------------------------
+void testArena(int iterations)
+{
+  AllocArena_t arena;
+  int i;
+
+  if (!allocArenaInit(&arena, ALLOC_TAG_GAMEMODE, ARENA_SIZE - 3) || arena.Size != ARENA_SIZE) {
+    fail("arena", "init did not round size to 16", arena.Size);
+    return;
+  }
+
+  for (i = 0; i < iterations && !Failures; ++i) {
+    int used = 0;
+
+    while (1) {
+      int size = rand() % 200;
+      u8 * ptr = allocArenaGet(&arena, size);
+      int rounded = (size + 0xF) & ~0xF;
+      if (!ptr) {
+        if (used + rounded <= ARENA_SIZE)
+          fail("arena", "failed with room left", used);
+        break;
+      }
+
+      if ((uintptr_t)ptr & 0xF || ptr != arena.Buffer + used)
+        fail("arena", "allocation not packed and aligned", used);
+
+      memset(ptr, 0x11, size);
+      used += rounded;
+    }
+
+    if (arena.Peak < arena.Offset || arena.Offset != used)
+      fail("arena", "offset or peak drifted", arena.Offset);
+
+    allocArenaReset(&arena);
+    if (arena.Offset != 0 || (AllocPoison && !checkFill(arena.Buffer, used, ALLOC_POISON_BYTE)))
+      fail("arena", "reset did not clear and poison", used);
+  }
+
+  allocArenaDestroy(&arena);
+  if (AllocTagStats[ALLOC_TAG_GAMEMODE].Current != 0 || allocArenaGet(&arena, 16) != NULL)
+    fail("arena", "destroy leaked or still allocates", AllocTagStats[ALLOC_TAG_GAMEMODE].Current);
+}
+
+//--------------------------------------------------------------------------
+double benchSeconds(clock_t start)
+{
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+//--------------------------------------------------------------------------
+// the same random get/put pattern against each allocator, BENCH_LIVE live at once
+void benchmark(int rounds, int size)
+{
+  static void * live[BENCH_LIVE];
+  static int order[BENCH_LIVE * 8];
+  AllocPool_t pool;
+  clock_t start;
+  double libc, tagged, pooled;
+  int i, r, n = sizeof(order) / sizeof(order[0]);
+
+  for (i = 0; i < n; ++i)
+    order[i] = rand() % BENCH_LIVE;
+
+  for (i = 0; i < BENCH_LIVE; ++i)
+    live[i] = malloc(size);
+  start = clock();
+  for (r = 0; r < rounds; ++r)
+    for (i = 0; i < n; ++i) {
+      free(live[order[i]]);
+      live[order[i]] = malloc(size);
+    }
+  libc = benchSeconds(start);
+  for (i = 0; i < BENCH_LIVE; ++i)
+    free(live[i]);
+
+  for (i = 0; i < BENCH_LIVE; ++i)
+    live[i] = allocTagged(ALLOC_TAG_DEFAULT, size);
+  start = clock();
+  for (r = 0; r < rounds; ++r)
+    for (i = 0; i < n; ++i) {
+      freeTagged(live[order[i]]);
+      live[order[i]] = allocTagged(ALLOC_TAG_DEFAULT, size);
+    }
+  tagged = benchSeconds(start);
+  for (i = 0; i < BENCH_LIVE; ++i)
+    freeTagged(live[i]);
+
+  allocPoolInit(&pool, ALLOC_TAG_DEFAULT, size, BENCH_LIVE);
+  for (i = 0; i < BENCH_LIVE; ++i)
+    live[i] = allocPoolGet(&pool);
+  start = clock();
+  for (r = 0; r < rounds; ++r)
+    for (i = 0; i < n; ++i) {
+      allocPoolPut(&pool, live[order[i]]);
+      live[order[i]] = allocPoolGet(&pool);
+    }
+  pooled = benchSeconds(start);
+  allocPoolDestroy(&pool);
+
+  double ops = (double)rounds * n;
+  printf("%6d bytes: libc %6.1f ns, tagged %6.1f ns, pool %6.1f ns per free+alloc\n",
+    size, libc * 1e9 / ops, tagged * 1e9 / ops, pooled * 1e9 / ops);
+}
+
+//--------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+  unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+  int poison;
+
+  srand(seed);
+  for (poison = 0; poison < 2; ++poison) {
+    allocSetPoison(poison);
+    testTagged(iterations);
+    testPool(iterations);
+    testArena(iterations / 100);
+  }
+
+  if (Failures) {
+    printf("%d failures (seed %u)\n", Failures, seed);
+    return 1;
+  }
+
+  printf("ok: %d iterations with and without poisoning (seed %u)\n", iterations, seed);
+
+  // poisoning is a DEBUG cost, time the release path
+  allocSetPoison(0);
+  benchmark(iterations / 2000 + 1, 64);
+  benchmark(iterations / 2000 + 1, 1024);
+  benchmark(iterations / 20000 + 1, BENCH_PREFETCH_BLOCK_SIZE);
+  return 0;
+}
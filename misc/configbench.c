@@ -0,0 +1,175 @@
+/***************************************************
+ * FILENAME :		configbench.c
+ * DESCRIPTION :
+ * 		Counts and times the text measurements the config menu
+ *    (patch/config.c drawFrame/drawTab) makes while it's open,
+ *    measuring every frame vs caching tab title widths and the
+ *    selected element's help width.
+ *
+ *    gfxGetFontWidth calls into the game's font code, so it is
+ *    modeled by fontWidth below, which sums a glyph width table over
+ *    the string. So the times only compare the two modes; the counts
+ *    are what the patch does. The tab names and help strings
+ *    are copied from patch/config.c.
+ *
+ *    gcc -O2 -o configbench configbench.c
+ *    ./configbench [frames] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SCREEN_WIDTH                (512)
+#define BENCH_MOVE_FRAMES           (20)  // cursor moves about every 1/3 second
+#define BENCH_TAB_FRAMES            (600) // tab switches about every 10 seconds
+
+typedef struct BenchTab
+{
+  const char * Name;
+  float NameWidth;
+  int SelectedIdx;
+} BenchTab_t;
+
+typedef struct BenchCounters
+{
+  long Calls;
+  long Chars;
+  double Seconds;
+} BenchCounters_t;
+
+// tabElements[]
+BenchTab_t Tabs[] = {
+  { "General" },
+  { "Game Settings" },
+  { "Game Settings" },
+  { "Custom Maps" },
+  { "Bots" },
+  { "Bots" },
+};
+
+// menuElementsGeneral[] help
+const char * Help[] = {
+  "Vote to end the game. If a team/player is in the lead they will win.",
+  "Refresh the custom map list.",
+  "Let that health bar hide no longer!  This will make it so the health bar is always visible.",
+  "Display team health and cycle v2 status on the bottom left of your screen.",
+  "Toggles code that pulls the camera towards nearby targets when aiming.",
+  "Toggles the camera shake caused by nearby explosions.",
+  "Disables the d-pad moving your character in game.",
+  "Toggles the in game FPS counter.",
+  "Hide the Flux's reticle to show how tough you really are!",
+  "The button that you will press to take out the hypershot.",
+  "Adjusts new player sync update frequency. High sends every tick, Very Low sends least often.",
+  "Main Weapon 1.  Defaults to Gravity Bomb if nothing is selected.",
+  "Change how short/long you need to hold triangle to open the Quick Select menu.",
+  "Tired of the same BORING songs in game?!  Spice it up by adding the music tracks from Single Player!",
+};
+
+#define TAB_COUNT                   ((int)(sizeof(Tabs) / sizeof(Tabs[0])))
+#define HELP_COUNT                  ((int)(sizeof(Help) / sizeof(Help[0])))
+
+unsigned char GlyphWidths[256];
+BenchCounters_t * Counters;
+
+//--------------------------------------------------------------------------
+float fontWidth(const char * string, int length, float scale)
+{
+  int i, width = 0;
+
+  Counters->Calls += 1;
+  for (i = 0; string[i] && (length < 0 || i < length); ++i)
+    width += GlyphWidths[(unsigned char)string[i]];
+
+  Counters->Chars += i;
+  return width * scale;
+}
+
+//--------------------------------------------------------------------------
+double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//--------------------------------------------------------------------------
+void run(BenchCounters_t * counters, int frames, unsigned int seed, int cached)
+{
+  const char * helpLastElement = NULL;
+  float helpLastWidth = 0;
+  volatile float sink = 0;
+  int frame, i, tab = 0;
+
+  Counters = counters;
+  srand(seed);
+  for (i = 0; i < TAB_COUNT; ++i) {
+    Tabs[i].NameWidth = 0;
+    Tabs[i].SelectedIdx = 0;
+  }
+
+  double start = now();
+  for (frame = 0; frame < frames; ++frame) {
+    if (frame % BENCH_TAB_FRAMES == BENCH_TAB_FRAMES - 1)
+      tab = rand() % TAB_COUNT;
+    if (frame % BENCH_MOVE_FRAMES == BENCH_MOVE_FRAMES - 1)
+      Tabs[tab].SelectedIdx = rand() % HELP_COUNT;
+
+    // drawFrame, tab bar
+    for (i = 0; i < TAB_COUNT; ++i) {
+      BenchTab_t * t = &Tabs[i];
+      if (!cached)
+        sink += fontWidth(t->Name, -1, 1) / (float)SCREEN_WIDTH;
+      else {
+        if (t->NameWidth <= 0)
+          t->NameWidth = fontWidth(t->Name, -1, 1) / (float)SCREEN_WIDTH;
+        sink += t->NameWidth;
+      }
+    }
+
+    // drawTab, help line of the selected element
+    const char * help = Help[Tabs[tab].SelectedIdx];
+    if (!cached)
+      sink += fontWidth(help, -1, 1) / (float)SCREEN_WIDTH;
+    else {
+      if (help != helpLastElement) {
+        helpLastElement = help;
+        helpLastWidth = fontWidth(help, -1, 1) / (float)SCREEN_WIDTH;
+      }
+      sink += helpLastWidth;
+    }
+  }
+
+  counters->Seconds = now() - start;
+}
+
+//--------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 60 * 60 * 10;
+  unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+  BenchCounters_t perFrame, cached;
+  int i;
+
+  for (i = 0; i < 256; ++i)
+    GlyphWidths[i] = 6 + (i * 7) % 9;
+
+  memset(&perFrame, 0, sizeof(perFrame));
+  memset(&cached, 0, sizeof(cached));
+  run(&perFrame, frames, seed, 0);
+  run(&cached, frames, seed, 1);
+
+  printf("%d frames, %d tabs, %d help strings\n", frames, TAB_COUNT, HELP_COUNT);
+  printf("mode      | measurements | chars walked | per frame | host ns/frame\n");
+  printf("per frame | %12ld | %12ld | %9.2f | %13.1f\n", perFrame.Calls, perFrame.Chars, perFrame.Calls / (double)frames, perFrame.Seconds * 1e9 / frames);
+  printf("cached    | %12ld | %12ld | %9.2f | %13.1f\n", cached.Calls, cached.Chars, cached.Calls / (double)frames, cached.Seconds * 1e9 / frames);
+
+  if (frames > 0 && cached.Calls >= perFrame.Calls) {
+    printf("FAIL: caching didn't save any measurements (seed %u)\n", seed);
+    return 1;
+  }
+
+  printf("ok: %.1fx fewer chars walked (seed %u)\n", cached.Chars ? perFrame.Chars / (double)cached.Chars : 0.0, seed);
+  return 0;
+}
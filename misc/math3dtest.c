@@ -0,0 +1,305 @@
+/***************************************************
+ * FILENAME :		math3dtest.c
+ * DESCRIPTION :
+ * 		Unit tests and throughput benchmark for the batched vector kernels.
+ *    The vu0 kernels in libuya/src/math3d.c can't run on the host, so
+ *    each one is modelled here instruction by instruction (lane masks,
+ *    ACC, Q) and checked against the plain c versions in
+ *    libuya/src/math3dref.c, including aliased output and empty batches.
+ *    On hardware the same comparison runs in vector_batch_selftest.
+ *
+ *    gcc -O2 -fsanitize=address,undefined -DMATH3D_HOST -iquote ../libuya/include -o math3dtest math3dtest.c -lm
+ *    ./math3dtest [iterations] [seed]
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "../libuya/src/math3dref.c"
+
+#define MAX_BATCH                   (64)
+#define BENCH_COUNT                 (4096)
+
+int Failures = 0;
+
+//--------------------------------------------------------------------------
+// vu0 models, one statement per instruction
+// vf0 is always (0, 0, 0, 1)
+//--------------------------------------------------------------------------
+void vu0ApplyBatch(VECTOR * output, VECTOR * input, int count, MATRIX matrix)
+{
+  VECTOR vf5, vf6, acc;
+  float * vf1 = &matrix[0], * vf2 = &matrix[4], * vf3 = &matrix[8], * vf4 = &matrix[12];
+  int j;
+
+  if (count <= 0)
+    return;
+
+  do {
+    memcpy(vf5, *input, sizeof(VECTOR));                      // lqc2 vf5
+    for (j = 0; j < 4; ++j) acc[j] = vf4[j] * 1;               // vmulaw ACC, vf4, vf0
+    for (j = 0; j < 4; ++j) acc[j] += vf1[j] * vf5[0];         // vmaddax ACC, vf1, vf5
+    for (j = 0; j < 4; ++j) acc[j] += vf2[j] * vf5[1];         // vmadday ACC, vf2, vf5
+    for (j = 0; j < 4; ++j) vf6[j] = acc[j] + vf3[j] * vf5[2]; // vmaddz vf6, vf3, vf5
+    memcpy(*output, vf6, sizeof(VECTOR));                     // sqc2 vf6
+    ++output; ++input;
+  } while (--count > 0);
+}
+
+//--------------------------------------------------------------------------
+void vu0LerpBatch(VECTOR * output, VECTOR * input0, VECTOR * input1, int count, float t)
+{
+  VECTOR vf1, vf2;
+  int j;
+
+  if (count <= 0)
+    return;
+
+  do {
+    memcpy(vf1, *input0, sizeof(VECTOR));                     // lqc2 vf1
+    memcpy(vf2, *input1, sizeof(VECTOR));                     // lqc2 vf2
+    for (j = 0; j < 3; ++j) vf2[j] = vf2[j] - vf1[j];          // vsub.xyz vf2, vf2, vf1
+    for (j = 0; j < 3; ++j) vf2[j] = vf2[j] * t;               // vmulx.xyz vf2, vf2, vf3x
+    for (j = 0; j < 3; ++j) vf1[j] = vf2[j] + vf1[j];          // vadd.xyz vf1, vf2, vf1
+    memcpy(*output, vf1, sizeof(VECTOR));                     // sqc2 vf1
+    ++output; ++input0; ++input1;
+  } while (--count > 0);
+}
+
+//--------------------------------------------------------------------------
+void vu0SqrdistBatch(float * output, VECTOR * input, int count, VECTOR point)
+{
+  VECTOR vf2, vf3 = { 1, 1, 1, 1 };                           // vmaxw.xyzw vf3, vf0, vf0w
+  float acc;
+  int j;
+
+  if (count <= 0)
+    return;
+
+  do {
+    memcpy(vf2, *input, sizeof(VECTOR));                      // lqc2 vf2
+    for (j = 0; j < 3; ++j) vf2[j] = vf2[j] - point[j];        // vsub.xyz vf2, vf2, vf1
+    for (j = 0; j < 3; ++j) vf2[j] = vf2[j] * vf2[j];          // vmul.xyz vf2, vf2, vf2
+    acc = vf2[0] + vf2[1];                                    // vadday.x ACC, vf2, vf2y
+    vf2[0] = acc + vf3[0] * vf2[2];                           // vmaddz.x vf2, vf3, vf2z
+    *output = vf2[0];                                         // sqc2, lw, sw
+    ++output; ++input;
+  } while (--count > 0);
+}
+
+//--------------------------------------------------------------------------
+void vu0NormalizeBatch(VECTOR * output, VECTOR * input, int count)
+{
+  VECTOR vf1, vf2;
+  float acc, q;
+  int j;
+
+  if (count <= 0)
+    return;
+
+  do {
+    memcpy(vf1, *input, sizeof(VECTOR));                      // lqc2 vf1
+    for (j = 0; j < 3; ++j) vf2[j] = vf1[j] * vf1[j];          // vmul.xyz vf2, vf1, vf1
+    acc = 1 * vf2[0];                                         // vmulax.w ACC, vf0, vf2
+    acc += 1 * vf2[1];                                        // vmadday.w ACC, vf0, vf2
+    vf2[3] = acc + 1 * vf2[2];                                // vmaddz.w vf2, vf0, vf2
+    q = 1 / sqrtf(vf2[3]);                                    // vrsqrt Q, vf0w, vf2w
+    vf1[3] = 1 - 1;                                           // vsub.w vf1, vf0, vf0
+    for (j = 0; j < 3; ++j) vf1[j] = vf1[j] * q;               // vmulq.xyz vf1, vf1, Q
+    memcpy(*output, vf1, sizeof(VECTOR));                     // sqc2 vf1
+    ++output; ++input;
+  } while (--count > 0);
+}
+
+//--------------------------------------------------------------------------
+float randFloat(float range)
+{
+  return ((float)rand() / RAND_MAX * 2 - 1) * range;
+}
+
+//--------------------------------------------------------------------------
+void randVectors(VECTOR * v, int count, float range)
+{
+  int i, j;
+
+  for (i = 0; i < count; ++i)
+    for (j = 0; j < 4; ++j)
+      v[i][j] = randFloat(range);
+}
+
+//--------------------------------------------------------------------------
+void check(const char * name, float * a, float * b, int count)
+{
+  if (!vector_batch_compare(name, a, b, count))
+    ++Failures;
+}
+
+//--------------------------------------------------------------------------
+void testRandom(int iterations)
+{
+  VECTOR a[MAX_BATCH], b[MAX_BATCH], out[MAX_BATCH], ref[MAX_BATCH];
+  float dist[MAX_BATCH], distRef[MAX_BATCH];
+  MATRIX m;
+  int i;
+
+  for (i = 0; i < iterations && !Failures; ++i) {
+    int count = 1 + rand() % MAX_BATCH;
+    float t = randFloat(1.5);
+
+    randVectors(a, count, 1000);
+    randVectors(b, count, 1000);
+    randVectors((VECTOR*)m, 4, 2);
+
+    vu0ApplyBatch(out, a, count, m);
+    vector_apply_batch_ref(ref, a, count, m);
+    check("apply", (float*)out, (float*)ref, count * 4);
+
+    vu0LerpBatch(out, a, b, count, t);
+    vector_lerp_batch_ref(ref, a, b, count, t);
+    check("lerp", (float*)out, (float*)ref, count * 4);
+
+    vu0SqrdistBatch(dist, a, count, b[0]);
+    vector_sqrdist_batch_ref(distRef, a, count, b[0]);
+    check("sqrdist", dist, distRef, count);
+
+    // the vu0 leaves w zeroed, a zero length input would be inf on both
+    vu0NormalizeBatch(out, b, count);
+    vector_normalize_batch_ref(ref, b, count);
+    check("normalize", (float*)out, (float*)ref, count * 4);
+  }
+}
+
+//--------------------------------------------------------------------------
+void testAliasing(void)
+{
+  VECTOR a[MAX_BATCH], b[MAX_BATCH], inPlace[MAX_BATCH], ref[MAX_BATCH];
+  MATRIX m;
+  int count = MAX_BATCH;
+
+  randVectors(a, count, 100);
+  randVectors(b, count, 100);
+  randVectors((VECTOR*)m, 4, 2);
+
+  // every kernel reads an element before it writes it, so output may be input
+  memcpy(inPlace, a, sizeof(a));
+  vu0ApplyBatch(inPlace, inPlace, count, m);
+  vector_apply_batch_ref(ref, a, count, m);
+  check("apply in place", (float*)inPlace, (float*)ref, count * 4);
+
+  memcpy(inPlace, a, sizeof(a));
+  vector_apply_batch_ref(inPlace, inPlace, count, m);
+  check("apply ref in place", (float*)inPlace, (float*)ref, count * 4);
+
+  memcpy(inPlace, a, sizeof(a));
+  vu0LerpBatch(inPlace, inPlace, b, count, 0.25);
+  vector_lerp_batch_ref(ref, a, b, count, 0.25);
+  check("lerp in place", (float*)inPlace, (float*)ref, count * 4);
+
+  memcpy(inPlace, b, sizeof(b));
+  vector_lerp_batch_ref(inPlace, a, inPlace, count, 0.25);
+  check("lerp ref in place", (float*)inPlace, (float*)ref, count * 4);
+
+  memcpy(inPlace, b, sizeof(b));
+  vu0NormalizeBatch(inPlace, inPlace, count);
+  vector_normalize_batch_ref(ref, b, count);
+  check("normalize in place", (float*)inPlace, (float*)ref, count * 4);
+}
+
+//--------------------------------------------------------------------------
+void testEmpty(void)
+{
+  VECTOR a[2], out[2], untouched[2];
+  float dist[2] = { 7, 7 };
+  MATRIX m;
+  int count;
+
+  randVectors(a, 2, 10);
+  randVectors(out, 2, 10);
+  randVectors((VECTOR*)m, 4, 2);
+  memcpy(untouched, out, sizeof(out));
+
+  // the vu0 loops test count after the first element, so <= 0 must return early
+  for (count = -1; count <= 0; ++count) {
+    vu0ApplyBatch(out, a, count, m);
+    vector_apply_batch_ref(out, a, count, m);
+    vu0LerpBatch(out, a, a, count, 0.5);
+    vector_lerp_batch_ref(out, a, a, count, 0.5);
+    vu0SqrdistBatch(dist, a, count, a[0]);
+    vector_sqrdist_batch_ref(dist, a, count, a[0]);
+    vu0NormalizeBatch(out, a, count);
+    vector_normalize_batch_ref(out, a, count);
+  }
+
+  if (memcmp(out, untouched, sizeof(out)) != 0 || dist[0] != 7 || dist[1] != 7) {
+    printf("FAIL empty: an empty batch wrote output\n");
+    ++Failures;
+  }
+}
+
+//--------------------------------------------------------------------------
+// one call per vector, what callers did before the batched kernels
+__attribute__((noinline)) void applySingle(VECTOR output, VECTOR input, MATRIX matrix)
+{
+  vector_apply_batch_ref((VECTOR*)output, (VECTOR*)input, 1, matrix);
+}
+
+//--------------------------------------------------------------------------
+double benchSeconds(clock_t start)
+{
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+//--------------------------------------------------------------------------
+void benchmark(int rounds)
+{
+  static VECTOR v[BENCH_COUNT];
+  MATRIX m;
+  clock_t start;
+  double batch, single, model;
+  int i, r;
+
+  randVectors(v, BENCH_COUNT, 10);
+  for (i = 0; i < 16; ++i)
+    m[i] = (i % 5) ? 0 : 1;
+
+  start = clock();
+  for (r = 0; r < rounds; ++r)
+    vector_apply_batch_ref(v, v, BENCH_COUNT, m);
+  batch = benchSeconds(start);
+
+  start = clock();
+  for (r = 0; r < rounds; ++r)
+    for (i = 0; i < BENCH_COUNT; ++i)
+      applySingle(v[i], v[i], m);
+  single = benchSeconds(start);
+
+  start = clock();
+  for (r = 0; r < rounds; ++r)
+    vu0ApplyBatch(v, v, BENCH_COUNT, m);
+  model = benchSeconds(start);
+
+  // host numbers only show the call overhead, the vu0 timings come from vector_batch_selftest
+  double n = (double)rounds * BENCH_COUNT;
+  printf("apply x%d, %d rounds: batch %.2f ns/vector, single %.2f ns/vector, vu0 model %.2f ns/vector\n",
+    BENCH_COUNT, rounds, batch * 1e9 / n, single * 1e9 / n, model * 1e9 / n);
+}
+
+//--------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+  unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+
+  srand(seed);
+  testEmpty();
+  testAliasing();
+  testRandom(iterations);
+
+  if (Failures) {
+    printf("%d failures (seed %u)\n", Failures, seed);
+    return 1;
+  }
+
+  printf("ok: %d random batches (seed %u)\n", iterations, seed);
+  benchmark(iterations / 100 + 1);
+  return 0;
+}
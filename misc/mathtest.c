@@ -0,0 +1,224 @@
+/***************************************************
+ * FILENAME :		mathtest.c
+ * DESCRIPTION :
+ * 		Error bound sweep for the fast trig in libuya/src/fastmath.c.
+ *    Sweeps every function against libm (in double) over |theta| <= 4pi
+ *    on a fixed grid plus random samples, and fails if the max absolute
+ *    error goes over the bound documented in libuya/include/fastmath.h.
+ *    Also times each one against the libm float version.
+ *
+ *    gcc -O2 -std=gnu89 -DMATH_HOST -iquote ../libuya/include -o mathtest mathtest.c -lm
+ *    ./mathtest [iterations] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../libuya/src/fastmath.c"
+
+#define SWEEP_RANGE                 (4 * M_PI)
+#define SWEEP_STEPS                 (1 << 20)
+
+#define BOUND_SIN                   (3.6e-6)
+#define BOUND_COS                   (3.6e-6)
+#define BOUND_ATAN2                 (2e-6)
+#define BOUND_ACOS                  (6.8e-5)
+
+typedef struct SweepResult
+{
+  const char * Name;
+  double Bound;
+  double MaxError;
+  double MaxErrorAt;
+  double MaxErrorAt2;
+  long Samples;
+} SweepResult_t;
+
+int Failures = 0;
+
+//--------------------------------------------------------------------------
+double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//--------------------------------------------------------------------------
+float randRange(float min, float max)
+{
+  return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+//--------------------------------------------------------------------------
+void record(SweepResult_t * result, double got, double expected, double at, double at2)
+{
+  double error = fabs(got - expected);
+
+  result->Samples += 1;
+  if (error != error || error > result->MaxError) {
+    result->MaxError = error;
+    result->MaxErrorAt = at;
+    result->MaxErrorAt2 = at2;
+  }
+}
+
+//--------------------------------------------------------------------------
+void sampleSincos(SweepResult_t * sinResult, SweepResult_t * cosResult, float theta)
+{
+  float s, c;
+
+  fastSincosf(theta, &s, &c);
+  record(sinResult, s, sin((double)theta), theta, 0);
+  record(cosResult, c, cos((double)theta), theta, 0);
+
+  // the single output versions must match the pair
+  if (fastSinf(theta) != s || fastCosf(theta) != c) {
+    printf("FAIL fastSinf/fastCosf(%.9g) disagree with fastSincosf\n", theta);
+    ++Failures;
+  }
+}
+
+//--------------------------------------------------------------------------
+void sampleAtan2(SweepResult_t * result, float y, float x)
+{
+  record(result, fastAtan2f(y, x), atan2((double)y, (double)x), y, x);
+}
+
+//--------------------------------------------------------------------------
+void sampleAcos(SweepResult_t * result, float v)
+{
+  record(result, fastAcosf(v), acos((double)v), v, 0);
+}
+
+//--------------------------------------------------------------------------
+void check(SweepResult_t * result)
+{
+  if (result->MaxError <= result->Bound)
+    return;
+
+  printf("FAIL %s: max error %.3g at (%.9g, %.9g) over bound %.3g\n", result->Name,
+    result->MaxError, result->MaxErrorAt, result->MaxErrorAt2, result->Bound);
+  ++Failures;
+}
+
+//--------------------------------------------------------------------------
+void bench(int iterations)
+{
+  volatile float sink = 0;
+  float inputs[1024];
+  double start, fast, libm;
+  int i, j;
+
+  for (i = 0; i < 1024; ++i)
+    inputs[i] = randRange(-SWEEP_RANGE, SWEEP_RANGE);
+
+  printf("function   | fast ns | libm ns\n");
+
+  start = now();
+  for (j = 0; j < iterations; ++j)
+    for (i = 0; i < 1024; ++i) {
+      float s, c;
+      fastSincosf(inputs[i], &s, &c);
+      sink += s + c;
+    }
+  fast = now() - start;
+  start = now();
+  for (j = 0; j < iterations; ++j)
+    for (i = 0; i < 1024; ++i)
+      sink += sinf(inputs[i]) + cosf(inputs[i]);
+  libm = now() - start;
+  printf("sincos     | %7.2f | %7.2f\n", fast * 1e9 / (iterations * 1024.0), libm * 1e9 / (iterations * 1024.0));
+
+  start = now();
+  for (j = 0; j < iterations; ++j)
+    for (i = 0; i < 1024; ++i)
+      sink += fastAtan2f(inputs[i], inputs[1023 - i]);
+  fast = now() - start;
+  start = now();
+  for (j = 0; j < iterations; ++j)
+    for (i = 0; i < 1024; ++i)
+      sink += atan2f(inputs[i], inputs[1023 - i]);
+  libm = now() - start;
+  printf("atan2      | %7.2f | %7.2f\n", fast * 1e9 / (iterations * 1024.0), libm * 1e9 / (iterations * 1024.0));
+
+  start = now();
+  for (j = 0; j < iterations; ++j)
+    for (i = 0; i < 1024; ++i)
+      sink += fastAcosf(inputs[i] * (1 / SWEEP_RANGE));
+  fast = now() - start;
+  start = now();
+  for (j = 0; j < iterations; ++j)
+    for (i = 0; i < 1024; ++i)
+      sink += acosf(inputs[i] * (1 / SWEEP_RANGE));
+  libm = now() - start;
+  printf("acos       | %7.2f | %7.2f\n", fast * 1e9 / (iterations * 1024.0), libm * 1e9 / (iterations * 1024.0));
+}
+
+//--------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 1000;
+  unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+  SweepResult_t results[4] = {
+    { "fastSinf", BOUND_SIN },
+    { "fastCosf", BOUND_COS },
+    { "fastAtan2f", BOUND_ATAN2 },
+    { "fastAcosf", BOUND_ACOS },
+  };
+  int i;
+
+  srand(seed);
+
+  // fixed grid, including both ends
+  for (i = 0; i <= SWEEP_STEPS; ++i) {
+    float t = (float)i / SWEEP_STEPS;
+    float theta = (float)(-SWEEP_RANGE + 2 * SWEEP_RANGE * t);
+    float angle = (float)(-M_PI + 2 * M_PI * t);
+
+    sampleSincos(&results[0], &results[1], theta);
+    sampleAtan2(&results[2], sinf(angle), cosf(angle));
+    sampleAcos(&results[3], -1 + 2 * t);
+  }
+
+  // edges the grid can miss
+  sampleSincos(&results[0], &results[1], 0);
+  sampleSincos(&results[0], &results[1], (float)(M_PI / 2));
+  sampleSincos(&results[0], &results[1], (float)-M_PI);
+  sampleSincos(&results[0], &results[1], (float)M_PI);
+  sampleAtan2(&results[2], 0, -1);
+  sampleAtan2(&results[2], 1, 1);
+  sampleAtan2(&results[2], -1e-20f, 1);
+  sampleAcos(&results[3], 1);
+  sampleAcos(&results[3], -1);
+  sampleAcos(&results[3], 0);
+  if (fastAtan2f(0, 0) != 0) {
+    printf("FAIL fastAtan2f(0, 0) = %.9g\n", fastAtan2f(0, 0));
+    ++Failures;
+  }
+
+  // random samples, atan2 at mixed magnitudes
+  for (i = 0; i < iterations * 1000; ++i) {
+    float scale = powf(10, randRange(-3, 3));
+    sampleSincos(&results[0], &results[1], randRange(-SWEEP_RANGE, SWEEP_RANGE));
+    sampleAtan2(&results[2], randRange(-1, 1) * scale, randRange(-1, 1) * scale);
+    sampleAcos(&results[3], randRange(-1, 1));
+  }
+
+  printf("function   |  samples | max error |    bound\n");
+  for (i = 0; i < 4; ++i) {
+    SweepResult_t * r = &results[i];
+    printf("%-10s | %8ld | %9.3g | %8.3g\n", r->Name, r->Samples, r->MaxError, r->Bound);
+    check(r);
+  }
+
+  bench(iterations / 10 + 1);
+
+  if (Failures) {
+    printf("%d failures (seed %u)\n", Failures, seed);
+    return 1;
+  }
+
+  printf("ok: %d iterations (seed %u)\n", iterations, seed);
+  return 0;
+}
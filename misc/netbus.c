@@ -0,0 +1,213 @@
+/***************************************************
+ * FILENAME :		netbus.c
+ * DESCRIPTION :
+ * 		In-process N-client message bus implementing the libuya
+ *    custom message api on the host. See netbus.h.
+ *
+ *    gcc -O2 -c netbus.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "netbus.h"
+
+typedef struct NetBusMessage
+{
+  int DeliverAt;
+  int Seq;
+  int From;
+  int To;
+  int Size;
+  unsigned char MsgId;
+  unsigned char Payload[NETBUS_MAX_PAYLOAD] __attribute__((aligned(16))); // handlers cast message structs onto it
+} NetBusMessage_t;
+
+struct NetBus
+{
+  int ClientCount;
+  int Current;
+  int Time;
+  int Seq;
+  int QueueCount;
+  int UplinkFreeAt[NETBUS_MAX_CLIENTS];
+  NetBusLink_t Link;
+  NET_CALLBACK_DELEGATE Handlers[NETBUS_MAX_CLIENTS][256];
+  NetBusStats_t Stats[256];
+  NetBusMessage_t Queue[NETBUS_MAX_QUEUED];
+} NetBus;
+
+//--------------------------------------------------------------------------
+void netBusInit(int clientCount, unsigned int seed)
+{
+  memset(&NetBus, 0, sizeof(NetBus));
+  NetBus.ClientCount = clientCount > NETBUS_MAX_CLIENTS ? NETBUS_MAX_CLIENTS : clientCount;
+  srand(seed);
+}
+
+//--------------------------------------------------------------------------
+void netBusSetLink(NetBusLink_t * link)
+{
+  memcpy(&NetBus.Link, link, sizeof(NetBusLink_t));
+}
+
+//--------------------------------------------------------------------------
+void netBusSetClient(int clientIndex)
+{
+  NetBus.Current = clientIndex;
+}
+
+//--------------------------------------------------------------------------
+int netBusGetClient(void)
+{
+  return NetBus.Current;
+}
+
+//--------------------------------------------------------------------------
+int netBusGetTime(void)
+{
+  return NetBus.Time;
+}
+
+//--------------------------------------------------------------------------
+NetBusStats_t * netBusGetStats(unsigned char msgId)
+{
+  return &NetBus.Stats[msgId];
+}
+
+//--------------------------------------------------------------------------
+void netBusEnqueue(int to, unsigned char msgId, int msgSize, void * payload)
+{
+  NetBusStats_t* stats = &NetBus.Stats[msgId];
+  NetBusLink_t* link = &NetBus.Link;
+  int from = NetBus.Current;
+
+  stats->Sent += 1;
+  stats->Bytes += msgSize;
+
+  // lost, or nowhere to put it
+  if (NetBus.QueueCount >= NETBUS_MAX_QUEUED || (link->LossRate > 0 && (rand() / (float)RAND_MAX) < link->LossRate)) {
+    stats->Dropped += 1;
+    return;
+  }
+
+  // serialize on the sender's uplink
+  int sendAt = NetBus.Time;
+  if (link->BytesPerSec > 0) {
+    if (NetBus.UplinkFreeAt[from] > sendAt)
+      sendAt = NetBus.UplinkFreeAt[from];
+    sendAt += (msgSize * 1000) / link->BytesPerSec;
+    NetBus.UplinkFreeAt[from] = sendAt;
+  }
+
+  NetBusMessage_t* msg = &NetBus.Queue[NetBus.QueueCount++];
+  msg->DeliverAt = sendAt + link->LatencyMs + (link->JitterMs > 0 ? rand() % (link->JitterMs + 1) : 0);
+  msg->Seq = NetBus.Seq++;
+  msg->From = from;
+  msg->To = to;
+  msg->Size = msgSize;
+  msg->MsgId = msgId;
+  if (payload && msgSize > 0)
+    memcpy(msg->Payload, payload, msgSize);
+}
+
+//--------------------------------------------------------------------------
+int netBusInject(int from, int to, int deliverAt, unsigned char msgId, int msgSize, void * payload)
+{
+  if (from < 0 || from >= NETBUS_MAX_CLIENTS || to < 0 || to >= NetBus.ClientCount)
+    return 0;
+  if (msgSize < 0 || msgSize > NETBUS_MAX_PAYLOAD || NetBus.QueueCount >= NETBUS_MAX_QUEUED)
+    return 0;
+
+  NetBus.Stats[msgId].Sent += 1;
+  NetBus.Stats[msgId].Bytes += msgSize;
+
+  NetBusMessage_t* msg = &NetBus.Queue[NetBus.QueueCount++];
+  msg->DeliverAt = deliverAt;
+  msg->Seq = NetBus.Seq++;
+  msg->From = from;
+  msg->To = to;
+  msg->Size = msgSize;
+  msg->MsgId = msgId;
+  if (payload && msgSize > 0)
+    memcpy(msg->Payload, payload, msgSize);
+
+  return 1;
+}
+
+//--------------------------------------------------------------------------
+int netBusStep(int ms)
+{
+  int i, delivered = 0;
+  int current = NetBus.Current;
+  NetBus.Time += ms;
+
+  while (1) {
+    // earliest due message
+    int best = -1;
+    for (i = 0; i < NetBus.QueueCount; ++i) {
+      NetBusMessage_t* msg = &NetBus.Queue[i];
+      if (msg->DeliverAt > NetBus.Time) continue;
+      if (best < 0 || msg->DeliverAt < NetBus.Queue[best].DeliverAt
+        || (msg->DeliverAt == NetBus.Queue[best].DeliverAt && msg->Seq < NetBus.Queue[best].Seq))
+        best = i;
+    }
+
+    if (best < 0) break;
+
+    NetBusMessage_t msg;
+    memcpy(&msg, &NetBus.Queue[best], sizeof(msg));
+    NetBus.Queue[best] = NetBus.Queue[--NetBus.QueueCount];
+
+    NET_CALLBACK_DELEGATE handler = NetBus.Handlers[msg.To][msg.MsgId];
+    if (!handler) continue;
+
+    // run the handler as the receiving client
+    NetBus.Current = msg.To;
+    clock_t start = clock();
+    handler(netGetDmeServerConnection(), msg.Payload);
+    NetBus.Stats[msg.MsgId].HandlerSeconds += (clock() - start) / (double)CLOCKS_PER_SEC;
+    NetBus.Stats[msg.MsgId].Delivered += 1;
+    delivered += 1;
+  }
+
+  NetBus.Current = current;
+  return delivered;
+}
+
+//--------------------------------------------------------------------------
+void netInstallCustomMsgHandler(unsigned char id, NET_CALLBACK_DELEGATE callback)
+{
+  NetBus.Handlers[NetBus.Current][id] = callback;
+}
+
+//--------------------------------------------------------------------------
+int netSendCustomAppMessage(void * connection, int clientIndex, unsigned char customMsgId, int msgSize, void * payload)
+{
+  if (!connection || clientIndex < 0 || clientIndex >= NetBus.ClientCount || msgSize > NETBUS_MAX_PAYLOAD)
+    return 0;
+
+  netBusEnqueue(clientIndex, customMsgId, msgSize, payload);
+  return 1;
+}
+
+//--------------------------------------------------------------------------
+int netBroadcastCustomAppMessage(void * connection, unsigned char customMsgId, int msgSize, void * payload)
+{
+  int i;
+  if (!connection || msgSize > NETBUS_MAX_PAYLOAD)
+    return 0;
+
+  for (i = 0; i < NetBus.ClientCount; ++i) {
+    if (i != NetBus.Current)
+      netBusEnqueue(i, customMsgId, msgSize, payload);
+  }
+
+  return 1;
+}
+
+//--------------------------------------------------------------------------
+void* netGetDmeServerConnection(void)
+{
+  return &NetBus;
+}
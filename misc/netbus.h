@@ -0,0 +1,57 @@
+/***************************************************
+ * FILENAME :		netbus.h
+ * DESCRIPTION :
+ * 		Host (Linux) stand-in for the libuya custom message API.
+ *    Runs several virtual clients in one process over a simulated
+ *    link with latency, jitter (reordering), loss and a bandwidth cap.
+ *
+ *    Compile it next to host builds of message handlers instead of
+ *    libuya/src/net.c. Call netBusSetClient() before running a client's
+ *    logic so its sends and handler installs are attributed to it.
+ */
+
+#ifndef _NETBUS_H_
+#define _NETBUS_H_
+
+#define NETBUS_MAX_CLIENTS              (8)
+#define NETBUS_MAX_QUEUED               (4096)
+#define NETBUS_MAX_PAYLOAD              (512)
+
+typedef int (*NET_CALLBACK_DELEGATE)(void * connection, void * data);
+
+typedef struct NetBusLink
+{
+  int LatencyMs;
+  int JitterMs;       // random extra delay, reorders messages
+  float LossRate;     // 0..1
+  int BytesPerSec;    // per sender uplink, 0 for unlimited
+} NetBusLink_t;
+
+typedef struct NetBusStats
+{
+  long Sent;
+  long Delivered;
+  long Dropped;
+  long Bytes;
+  double HandlerSeconds;
+} NetBusStats_t;
+
+// libuya net.h api
+void netInstallCustomMsgHandler(unsigned char id, NET_CALLBACK_DELEGATE callback);
+int netSendCustomAppMessage(void * connection, int clientIndex, unsigned char customMsgId, int msgSize, void * payload);
+int netBroadcastCustomAppMessage(void * connection, unsigned char customMsgId, int msgSize, void * payload);
+void* netGetDmeServerConnection(void);
+
+// bus control
+void netBusInit(int clientCount, unsigned int seed);
+void netBusSetLink(NetBusLink_t * link);
+void netBusSetClient(int clientIndex);
+int netBusGetClient(void);
+int netBusGetTime(void);
+int netBusStep(int ms);
+NetBusStats_t * netBusGetStats(unsigned char msgId);
+
+// replay, queue a message for client to at time deliverAt, outside the link model
+int netBusInject(int from, int to, int deliverAt, unsigned char msgId, int msgSize, void * payload);
+
+#endif // _NETBUS_H_
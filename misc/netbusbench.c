@@ -0,0 +1,281 @@
+/***************************************************
+ * FILENAME :		netbusbench.c
+ * DESCRIPTION :
+ * 		Drives misc/netbus.c with the spleef box protocol
+ *    (CUSTOM_MSG_DESTROY_BOX batches plus the host's periodic
+ *    CUSTOM_MSG_BOARD_SYNC) across several link profiles.
+ *    Each round plays for a while, then stops breaking boxes and
+ *    measures how long the clients' boards take to agree.
+ *    Reports message volume, handler cost and convergence time.
+ *
+ *    The message layouts come from spleef/include/messages.h.
+ *    The handler logic mirrors spleef/main.c, the real handlers also
+ *    touch mobys and players, so they can't be compiled for the host
+ *    and are modeled here instead.
+ *
+ *    gcc -O2 -I../common -o netbusbench netbusbench.c netbus.c
+ *    ./netbusbench [clients] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "netbus.h"
+
+#define SPLEEF_MESSAGES_HOST
+#include "../spleef/include/messages.h"
+
+#define BENCH_TICK_MS                       (16)
+#define BENCH_BREAKS_PER_SEC                (1)   // per client
+#define BENCH_ROUND_PLAY_MS                 (8000)
+#define BENCH_CONVERGE_TIMEOUT_MS           (10000)
+
+typedef struct BenchClient
+{
+  uint32_t Board[SPLEEF_BOARD_WORDS];
+  uint32_t Pending[SPLEEF_BOARD_WORDS];
+  uint32_t HostMissing[SPLEEF_BOARD_WORDS];
+  int PendingCount;
+} BenchClient_t;
+
+typedef struct BenchProfile
+{
+  const char * Name;
+  NetBusLink_t Link;
+} BenchProfile_t;
+
+BenchClient_t Clients[NETBUS_MAX_CLIENTS];
+int ClientCount = 4;
+int RoundNumber = 0;
+
+//--------------------------------------------------------------------------
+uint32_t boardChecksum(uint32_t * board)
+{
+  int i;
+  uint8_t * bytes = (uint8_t*)board;
+  uint32_t hash = 2166136261u;
+
+  for (i = 0; i < SPLEEF_BOARD_WORDS * (int)sizeof(uint32_t); ++i)
+    hash = (hash ^ bytes[i]) * 16777619u;
+
+  return hash;
+}
+
+//--------------------------------------------------------------------------
+int onDestroyBoxRemote(void * connection, void * data)
+{
+  SpleefDestroyBoxMessage_t * message = (SpleefDestroyBoxMessage_t*)data;
+  BenchClient_t * client = &Clients[netBusGetClient()];
+  int i;
+
+  // ignore stale rounds
+  if (message->RoundNumber != RoundNumber)
+    return sizeof(SpleefDestroyBoxMessage_t);
+
+  for (i = 0; i < SPLEEF_BOARD_WORDS; ++i)
+    client->Board[i] &= ~message->Destroyed[i];
+
+  return sizeof(SpleefDestroyBoxMessage_t);
+}
+
+//--------------------------------------------------------------------------
+int onBoardSyncRemote(void * connection, void * data)
+{
+  SpleefBoardSyncMessage_t * message = (SpleefBoardSyncMessage_t*)data;
+  BenchClient_t * client = &Clients[netBusGetClient()];
+  int i;
+
+  SpleefDestroyBoxMessage_t resend;
+  uint32_t missing = 0;
+
+  if (message->RoundNumber != RoundNumber || message->Checksum == boardChecksum(client->Board))
+    return sizeof(SpleefBoardSyncMessage_t);
+
+  // boxes never come back mid round, send back what the host missed
+  // two syncs running and destroy what it no longer has
+  memset(&resend, 0, sizeof(resend));
+  for (i = 0; i < SPLEEF_BOARD_WORDS; ++i) {
+    uint32_t hostMissing = message->Board[i] & ~client->Board[i];
+    resend.Destroyed[i] = hostMissing & client->HostMissing[i];
+    client->HostMissing[i] = hostMissing & ~resend.Destroyed[i];
+    missing |= resend.Destroyed[i];
+    client->Board[i] &= message->Board[i];
+  }
+
+  if (missing) {
+    resend.RoundNumber = RoundNumber;
+    resend.PlayerId = -1;
+    netBroadcastCustomAppMessage(netGetDmeServerConnection(), CUSTOM_MSG_DESTROY_BOX, sizeof(resend), &resend);
+  }
+
+  return sizeof(SpleefBoardSyncMessage_t);
+}
+
+//--------------------------------------------------------------------------
+void breakRandomBox(int clientIdx)
+{
+  BenchClient_t * client = &Clients[clientIdx];
+  int id = rand() % SPLEEF_BOARD_BOX_MAX;
+
+  if (!SPLEEF_BOARD_TEST(client->Board, id))
+    return;
+
+  SPLEEF_BOARD_CLEAR(client->Board, id);
+  SPLEEF_BOARD_SET(client->Pending, id);
+  ++client->PendingCount;
+}
+
+//--------------------------------------------------------------------------
+void flushDestroyedBoxes(int clientIdx)
+{
+  BenchClient_t * client = &Clients[clientIdx];
+  SpleefDestroyBoxMessage_t message;
+
+  if (!client->PendingCount)
+    return;
+
+  memset(&message, 0, sizeof(message));
+  message.RoundNumber = RoundNumber;
+  message.PlayerId = clientIdx;
+  memcpy(message.Destroyed, client->Pending, sizeof(message.Destroyed));
+  netBroadcastCustomAppMessage(netGetDmeServerConnection(), CUSTOM_MSG_DESTROY_BOX, sizeof(message), &message);
+
+  memset(client->Pending, 0, sizeof(client->Pending));
+  client->PendingCount = 0;
+}
+
+//--------------------------------------------------------------------------
+void sendBoardSync(void)
+{
+  SpleefBoardSyncMessage_t message;
+
+  memset(&message, 0, sizeof(message));
+  message.RoundNumber = RoundNumber;
+  message.Checksum = boardChecksum(Clients[0].Board);
+  memcpy(message.Board, Clients[0].Board, sizeof(message.Board));
+  netBroadcastCustomAppMessage(netGetDmeServerConnection(), CUSTOM_MSG_BOARD_SYNC, sizeof(message), &message);
+}
+
+//--------------------------------------------------------------------------
+int boardsAgree(void)
+{
+  int i;
+
+  for (i = 1; i < ClientCount; ++i)
+    if (memcmp(Clients[i].Board, Clients[0].Board, sizeof(Clients[0].Board)) != 0)
+      return 0;
+
+  return 1;
+}
+
+//--------------------------------------------------------------------------
+// returns ms from the end of play until every board agrees, or -1
+int runRound(int * nextSync)
+{
+  int i;
+  int playEnd = netBusGetTime() + BENCH_ROUND_PLAY_MS;
+
+  ++RoundNumber;
+  for (i = 0; i < ClientCount; ++i) {
+    memset(Clients[i].Board, 0xFF, sizeof(Clients[i].Board));
+    memset(Clients[i].Pending, 0, sizeof(Clients[i].Pending));
+    memset(Clients[i].HostMissing, 0, sizeof(Clients[i].HostMissing));
+    Clients[i].PendingCount = 0;
+  }
+
+  while (netBusGetTime() < playEnd + BENCH_CONVERGE_TIMEOUT_MS) {
+    int now = netBusGetTime();
+
+    for (i = 0; i < ClientCount; ++i) {
+      netBusSetClient(i);
+      if (now < playEnd && (rand() % (1000 / BENCH_TICK_MS)) < BENCH_BREAKS_PER_SEC)
+        breakRandomBox(i);
+      flushDestroyedBoxes(i);
+    }
+
+    netBusSetClient(0);
+    if (now >= *nextSync) {
+      sendBoardSync();
+      *nextSync = now + SPLEEF_BOARD_SYNC_INTERVAL;
+    }
+
+    netBusStep(BENCH_TICK_MS);
+
+    if (netBusGetTime() >= playEnd && boardsAgree())
+      return netBusGetTime() - playEnd;
+  }
+
+  return -1;
+}
+
+//--------------------------------------------------------------------------
+void runProfile(BenchProfile_t * profile, int rounds)
+{
+  int i, msgId;
+  int nextSync = SPLEEF_BOARD_SYNC_INTERVAL;
+  int convergedRounds = 0, convergeSum = 0, convergeMax = 0;
+
+  netBusInit(ClientCount, 1234);
+  netBusSetLink(&profile->Link);
+  memset(Clients, 0, sizeof(Clients));
+
+  for (i = 0; i < ClientCount; ++i) {
+    netBusSetClient(i);
+    netInstallCustomMsgHandler(CUSTOM_MSG_DESTROY_BOX, &onDestroyBoxRemote);
+    netInstallCustomMsgHandler(CUSTOM_MSG_BOARD_SYNC, &onBoardSyncRemote);
+  }
+
+  for (i = 0; i < rounds; ++i) {
+    int converged = runRound(&nextSync);
+    if (converged < 0)
+      continue;
+
+    ++convergedRounds;
+    convergeSum += converged;
+    if (converged > convergeMax)
+      convergeMax = converged;
+  }
+
+  double seconds = netBusGetTime() / 1000.0;
+  printf("%-8s", profile->Name);
+  for (msgId = CUSTOM_MSG_DESTROY_BOX; msgId <= CUSTOM_MSG_BOARD_SYNC; ++msgId) {
+    NetBusStats_t * stats = netBusGetStats(msgId);
+    printf(" | %5.1f msg/s %6.0f B/s %5.2f us",
+      stats->Sent / seconds,
+      stats->Bytes / seconds,
+      stats->Delivered ? (stats->HandlerSeconds * 1e6) / stats->Delivered : 0);
+  }
+
+  printf(" | %3d/%-3d avg %5d ms max %5d ms\n",
+    convergedRounds, rounds,
+    convergedRounds ? convergeSum / convergedRounds : 0,
+    convergeMax);
+}
+
+int main(int argc, char** argv)
+{
+  int i, rounds = 20;
+  BenchProfile_t profiles[] = {
+    { "lan",     { .LatencyMs = 5 } },
+    { "wan",     { .LatencyMs = 80, .JitterMs = 40 } },
+    { "lossy",   { .LatencyMs = 80, .JitterMs = 40, .LossRate = 0.02 } },
+    { "capped",  { .LatencyMs = 80, .JitterMs = 40, .BytesPerSec = 256 } },
+  };
+
+  if (argc > 1)
+    ClientCount = atoi(argv[1]);
+  if (argc > 2)
+    rounds = atoi(argv[2]);
+  if (ClientCount < 2 || ClientCount > NETBUS_MAX_CLIENTS || rounds <= 0) {
+    fprintf(stderr, "usage: %s [clients 2-%d] [rounds]\n", argv[0], NETBUS_MAX_CLIENTS);
+    return 1;
+  }
+
+  printf("%d clients, %d rounds\n", ClientCount, rounds);
+  printf("profile  | destroy box                        | board sync                         | rounds converged\n");
+  for (i = 0; i < (int)(sizeof(profiles) / sizeof(profiles[0])); ++i)
+    runProfile(&profiles[i], rounds);
+
+  return 0;
+}
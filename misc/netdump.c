@@ -0,0 +1,256 @@
+/***************************************************
+ * FILENAME :		netdump.c
+ * DESCRIPTION :
+ * 		Host tool for captures written by patch/netrecord.c.
+ *    Prints every record, or with -s per message id totals
+ *    (count, bytes, msgs/sec and receive inter-arrival jitter).
+ *
+ *    With -r the received records are replayed through misc/netbus.c,
+ *    each one delivered at its recorded time to the handlers installed
+ *    for client 0, the capturing client. The tool's own handler prints
+ *    each delivery and checks its time and payload. Host harnesses for
+ *    a mode build with NETDUMP_NO_MAIN, install the mode's handlers on
+ *    client 0 and call netDumpReplay().
+ *
+ *    gcc -O2 -o netdump netdump.c netbus.c -lm
+ *    ./netdump [-s | -r] netrec_XXXXXXXX.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "netbus.h"
+
+#define NET_RECORD_MAGIC              (0x4345524E) // NREC
+#define NET_RECORD_VERSION            (1)
+
+typedef struct NetRecordHeader
+{
+  uint32_t Magic;
+  uint16_t Version;
+  uint16_t EntrySize;
+  int32_t ClientId;
+  int32_t StartTime;
+  int32_t RecordCount;
+  int32_t Dropped;
+} NetRecordHeader_t;
+
+typedef struct NetRecordEntry
+{
+  int32_t Time;
+  uint8_t Direction;
+  uint8_t MsgId;
+  int16_t ClientIndex;
+  uint16_t Size;
+  uint16_t Pad;
+} NetRecordEntry_t;
+
+typedef struct MsgStats
+{
+  int Count[2];
+  long Bytes[2];
+  int LastRecvTime;
+  double GapSum;
+  double GapSqrSum;
+  int Gaps;
+} MsgStats_t;
+
+// the record being replayed, for handlers that want its id or timing
+NetRecordEntry_t NetDumpReplayEntry;
+unsigned char NetDumpReplayPayload[NETBUS_MAX_PAYLOAD];
+int NetDumpReplayAt;
+int NetDumpReplayErrors = 0;
+
+//--------------------------------------------------------------------------
+FILE* netDumpOpen(const char* path, NetRecordHeader_t* header)
+{
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return NULL;
+  }
+
+  if (fread(header, sizeof(NetRecordHeader_t), 1, f) != 1 || header->Magic != NET_RECORD_MAGIC || header->Version != NET_RECORD_VERSION) {
+    fprintf(stderr, "%s: not a version %d capture\n", path, NET_RECORD_VERSION);
+    fclose(f);
+    return NULL;
+  }
+
+  // newer captures may append fields to each entry, skip what we don't know
+  if (header->EntrySize < sizeof(NetRecordEntry_t)) {
+    fprintf(stderr, "%s: entry size %d is smaller than %d\n", path, header->EntrySize, (int)sizeof(NetRecordEntry_t));
+    fclose(f);
+    return NULL;
+  }
+
+  return f;
+}
+
+//--------------------------------------------------------------------------
+int netDumpRead(FILE* f, NetRecordHeader_t* header, int index, NetRecordEntry_t* entry, unsigned char* payload, int payloadSize)
+{
+  if (fread(entry, sizeof(NetRecordEntry_t), 1, f) != 1 || fseek(f, header->EntrySize - sizeof(NetRecordEntry_t), SEEK_CUR) != 0) {
+    fprintf(stderr, "truncated at record %d\n", index);
+    return 0;
+  }
+
+  int padded = (entry->Size + 3) & ~3;
+  if (padded > payloadSize || fread(payload, 1, padded, f) != (size_t)padded) {
+    fprintf(stderr, "bad payload at record %d\n", index);
+    return 0;
+  }
+
+  return 1;
+}
+
+//--------------------------------------------------------------------------
+int netDumpReplay(const char* path, int client)
+{
+  NetRecordHeader_t header;
+  int i, firstTime = 0, delivered = 0;
+  int base = netBusGetTime();
+
+  FILE* f = netDumpOpen(path, &header);
+  if (!f)
+    return -1;
+
+  for (i = 0; i < header.RecordCount; ++i) {
+    if (!netDumpRead(f, &header, i, &NetDumpReplayEntry, NetDumpReplayPayload, sizeof(NetDumpReplayPayload)))
+      break;
+
+    if (i == 0) firstTime = NetDumpReplayEntry.Time;
+
+    // sends were handled by the other clients, who weren't recorded
+    if (NetDumpReplayEntry.Direction)
+      continue;
+
+    // run the bus up to the record's time, then hand it over
+    NetDumpReplayAt = base + NetDumpReplayEntry.Time - firstTime;
+    if (NetDumpReplayAt > netBusGetTime())
+      netBusStep(NetDumpReplayAt - netBusGetTime());
+    else
+      NetDumpReplayAt = netBusGetTime();
+
+    if (!netBusInject(client, client, NetDumpReplayAt, NetDumpReplayEntry.MsgId, NetDumpReplayEntry.Size, NetDumpReplayPayload)) {
+      fprintf(stderr, "record %d: can't replay %d bytes\n", i, NetDumpReplayEntry.Size);
+      continue;
+    }
+
+    delivered += netBusStep(0);
+  }
+
+  fclose(f);
+  return delivered;
+}
+
+#ifndef NETDUMP_NO_MAIN
+//--------------------------------------------------------------------------
+int netDumpReplayHandler(void * connection, void * data)
+{
+  NetRecordEntry_t* entry = &NetDumpReplayEntry;
+
+  printf("%8d replay id:%3d client:%3d size:%4d\n", netBusGetTime(), entry->MsgId, entry->ClientIndex, entry->Size);
+  if (netBusGetTime() != NetDumpReplayAt || memcmp(data, NetDumpReplayPayload, entry->Size) != 0) {
+    printf("FAIL replay id:%d expected at %d\n", entry->MsgId, NetDumpReplayAt);
+    ++NetDumpReplayErrors;
+  }
+
+  return entry->Size;
+}
+
+//--------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  NetRecordHeader_t header;
+  NetRecordEntry_t entry;
+  MsgStats_t stats[256];
+  unsigned char payload[4096];
+  int summary = 0, replay = 0, i, j;
+  int firstTime = 0, lastTime = 0;
+
+  if (argc > 2 && strcmp(argv[1], "-s") == 0) {
+    summary = 1;
+    argv++; argc--;
+  } else if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+    replay = 1;
+    argv++; argc--;
+  }
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s [-s | -r] capture.bin\n", argv[0]);
+    return 1;
+  }
+
+  if (replay) {
+    netBusInit(1, 1);
+    for (i = 0; i < 256; ++i)
+      netInstallCustomMsgHandler(i, &netDumpReplayHandler);
+
+    int delivered = netDumpReplay(argv[1], 0);
+    if (delivered < 0)
+      return 1;
+
+    printf("replayed %d records over %d ms, %d errors\n", delivered, netBusGetTime(), NetDumpReplayErrors);
+    return NetDumpReplayErrors ? 1 : 0;
+  }
+
+  FILE* f = netDumpOpen(argv[1], &header);
+  if (!f)
+    return 1;
+
+  printf("client %d, start %d, %d records, %d dropped\n", header.ClientId, header.StartTime, header.RecordCount, header.Dropped);
+  memset(stats, 0, sizeof(stats));
+
+  for (i = 0; i < header.RecordCount; ++i) {
+    if (!netDumpRead(f, &header, i, &entry, payload, sizeof(payload)))
+      break;
+
+    if (i == 0) firstTime = entry.Time;
+    lastTime = entry.Time;
+
+    MsgStats_t* s = &stats[entry.MsgId];
+    int dir = entry.Direction ? 1 : 0;
+    s->Count[dir] += 1;
+    s->Bytes[dir] += entry.Size;
+    if (!dir) {
+      if (s->Count[0] > 1) {
+        double gap = entry.Time - s->LastRecvTime;
+        s->GapSum += gap;
+        s->GapSqrSum += gap * gap;
+        s->Gaps += 1;
+      }
+      s->LastRecvTime = entry.Time;
+    }
+
+    if (summary) continue;
+
+    printf("%8d %s id:%3d client:%3d size:%4d ", entry.Time, dir ? "send" : "recv", entry.MsgId, entry.ClientIndex, entry.Size);
+    for (j = 0; j < entry.Size && j < 32; ++j)
+      printf("%02X", payload[j]);
+    printf("%s\n", entry.Size > 32 ? "..." : "");
+  }
+
+  if (summary) {
+    double seconds = (lastTime - firstTime) / 1000.0;
+    if (seconds <= 0) seconds = 1;
+
+    printf(" id | recv  bytes  /sec | send  bytes  /sec | recv gap ms (mean/stddev)\n");
+    for (i = 0; i < 256; ++i) {
+      MsgStats_t* s = &stats[i];
+      if (!s->Count[0] && !s->Count[1]) continue;
+
+      double mean = s->Gaps ? s->GapSum / s->Gaps : 0;
+      double var = s->Gaps ? (s->GapSqrSum / s->Gaps) - (mean * mean) : 0;
+      printf("%3d | %5d %6ld %5.1f | %5d %6ld %5.1f | %7.1f / %.1f\n", i,
+        s->Count[0], s->Bytes[0], s->Count[0] / seconds,
+        s->Count[1], s->Bytes[1], s->Count[1] / seconds,
+        mean, var > 0 ? sqrt(var) : 0);
+    }
+  }
+
+  fclose(f);
+  return 0;
+}
+#endif // NETDUMP_NO_MAIN
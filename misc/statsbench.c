@@ -0,0 +1,257 @@
+/***************************************************
+ * FILENAME :		statsbench.c
+ * DESCRIPTION :
+ * 		Benchmarks the compact stats encoding on the stat layouts
+ *    the game modes keep, sampled once a second over simulated
+ *    matches. Reports raw and encoded sizes and encode/decode time.
+ *
+ *    infected   : struct InfectedGameData (infected/main.c)
+ *    koth       : kothScores plus the frag kills/deaths koth/game.c reads
+ *    domination : DominationBase state/bias/color (domination/game.c)
+ *                 and the UpdateGameStateRequest_t patch/main.c sends
+ *
+ *    The mode structs live in the modules' .c files next to ps2sdk
+ *    code, so the layouts are mirrored here.
+ *
+ *    gcc -O2 -o statsbench statsbench.c
+ *    ./statsbench [matches] [seed]
+ */
+
+#define STATS_DECODE_NO_MAIN
+#include "statsdecode.c"
+#include "../common/statscompact.c"
+
+#include <time.h>
+
+#define GAME_MAX_PLAYERS            (10)
+#define BENCH_PLAYERS               (8)
+#define BENCH_MATCH_SECONDS         (600)
+#define BENCH_DOMINATION_BASES      (5)
+
+// infected/main.c
+struct InfectedGameData
+{
+  u32 Version;
+  int Infections[GAME_MAX_PLAYERS];
+  char IsInfected[GAME_MAX_PLAYERS];
+  char IsFirstInfected[GAME_MAX_PLAYERS];
+};
+
+// kothScores and the frag kills/deaths koth/game.c reads
+struct KothGameData
+{
+  u32 Version;
+  int Scores[GAME_MAX_PLAYERS];
+  int Kills[GAME_MAX_PLAYERS];
+  int Deaths[GAME_MAX_PLAYERS];
+};
+
+// common/module.h
+typedef struct UpdateGameStateRequest {
+  char TeamsEnabled;
+  char PADDING;
+  short Version;
+  int TeamScores[GAME_MAX_PLAYERS];
+  char ClientIds[GAME_MAX_PLAYERS];
+  char Teams[GAME_MAX_PLAYERS];
+  int Nodes[2]; // Blue Team, Red Team
+} UpdateGameStateRequest_t;
+
+// DominationBase fields (domination/game.c) and the game state update
+struct DominationGameData
+{
+  u32 Version;
+  int BaseCount;
+  int State[8];
+  float Bias[8];
+  int Color[8];
+  UpdateGameStateRequest_t GameState;
+};
+
+typedef struct BenchResult
+{
+  const char * Name;
+  int RawSize;
+  long Samples;
+  long EncodedBytes;
+  int EncodedMin;
+  int EncodedMax;
+  int Stored;
+  double EncodeSeconds;
+  double DecodeSeconds;
+} BenchResult_t;
+
+int Failures = 0;
+
+//--------------------------------------------------------------------------
+double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//--------------------------------------------------------------------------
+void sample(BenchResult_t * result, void * payload, int size)
+{
+  uint8_t encoded[STATS_MAX_SIZE * 2];
+  uint8_t decoded[STATS_MAX_SIZE];
+  double start;
+
+  start = now();
+  int encodedSize = statsCompactEncode(payload, size, encoded, sizeof(encoded));
+  result->EncodeSeconds += now() - start;
+
+  start = now();
+  int decodedSize = statsCompactDecode(encoded, encodedSize, decoded, sizeof(decoded));
+  result->DecodeSeconds += now() - start;
+
+  if (encodedSize < 0 || decodedSize != size || memcmp(decoded, payload, size) != 0) {
+    printf("FAIL %s: %d bytes round tripped to %d\n", result->Name, size, decodedSize);
+    ++Failures;
+    return;
+  }
+
+  result->RawSize = size;
+  result->Samples += 1;
+  result->EncodedBytes += encodedSize;
+  if (!result->EncodedMin || encodedSize < result->EncodedMin)
+    result->EncodedMin = encodedSize;
+  if (encodedSize > result->EncodedMax)
+    result->EncodedMax = encodedSize;
+  if (encoded[0] & STATS_COMPACT_STORED)
+    result->Stored += 1;
+}
+
+//--------------------------------------------------------------------------
+void benchInfected(BenchResult_t * result)
+{
+  struct InfectedGameData data;
+  int t, i;
+
+  memset(&data, 0, sizeof(data));
+  data.Version = 1;
+
+  // one player starts infected and it spreads
+  int first = rand() % BENCH_PLAYERS;
+  data.IsInfected[first] = 1;
+  data.IsFirstInfected[first] = 1;
+
+  for (t = 0; t < BENCH_MATCH_SECONDS; ++t) {
+    if (rand() % 20 == 0) {
+      int victim = rand() % BENCH_PLAYERS;
+      if (!data.IsInfected[victim]) {
+        for (i = rand() % BENCH_PLAYERS; !data.IsInfected[i]; i = (i + 1) % BENCH_PLAYERS)
+          ;
+        data.IsInfected[victim] = 1;
+        data.Infections[i] += 1;
+      }
+    }
+
+    sample(result, &data, sizeof(data));
+  }
+}
+
+//--------------------------------------------------------------------------
+void benchKoth(BenchResult_t * result)
+{
+  struct KothGameData data;
+  int t, i;
+
+  memset(&data, 0, sizeof(data));
+  data.Version = 1;
+
+  for (t = 0; t < BENCH_MATCH_SECONDS; ++t) {
+    // whoever holds the hill scores a point a second
+    int holder = rand() % (BENCH_PLAYERS + 2);
+    if (holder < BENCH_PLAYERS)
+      data.Scores[holder] += 1;
+
+    if (rand() % 8 == 0) {
+      i = rand() % BENCH_PLAYERS;
+      data.Kills[i] += 1;
+      data.Deaths[(i + 1 + rand() % (BENCH_PLAYERS - 1)) % BENCH_PLAYERS] += 1;
+    }
+
+    sample(result, &data, sizeof(data));
+  }
+}
+
+//--------------------------------------------------------------------------
+void benchDomination(BenchResult_t * result)
+{
+  struct DominationGameData data;
+  int t, i;
+
+  memset(&data, 0, sizeof(data));
+  data.Version = 1;
+  data.BaseCount = BENCH_DOMINATION_BASES;
+  data.GameState.TeamsEnabled = 1;
+  data.GameState.Version = 1;
+  for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
+    data.GameState.ClientIds[i] = i < BENCH_PLAYERS ? 10 + i : -1;
+    data.GameState.Teams[i] = i < BENCH_PLAYERS ? i & 1 : -1;
+  }
+
+  for (t = 0; t < BENCH_MATCH_SECONDS; ++t) {
+    // bases drift toward a team while contested, then flip
+    for (i = 0; i < data.BaseCount; ++i) {
+      if (rand() % 4 == 0)
+        data.Bias[i] += ((rand() % 3) - 1) * 0.1f;
+      if (data.Bias[i] > 1) data.Bias[i] = 1;
+      if (data.Bias[i] < -1) data.Bias[i] = -1;
+
+      data.State[i] = data.Bias[i] >= 1 ? 1 : data.Bias[i] <= -1 ? 2 : 0;
+      data.Color[i] = data.State[i] == 1 ? 0x80FF0000 : data.State[i] == 2 ? 0x800000FF : 0x80FFFFFF;
+      if (data.State[i])
+        data.GameState.TeamScores[data.State[i] - 1] += 1;
+    }
+
+    data.GameState.Nodes[0] = data.GameState.Nodes[1] = 0;
+    for (i = 0; i < data.BaseCount; ++i) {
+      if (data.State[i])
+        data.GameState.Nodes[data.State[i] - 1] += 1;
+    }
+
+    sample(result, &data, sizeof(data));
+  }
+}
+
+//--------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  int matches = argc > 1 ? atoi(argv[1]) : 20;
+  unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+  BenchResult_t results[3];
+  int i, j;
+
+  memset(results, 0, sizeof(results));
+  results[0].Name = "infected";
+  results[1].Name = "koth";
+  results[2].Name = "domination";
+
+  srand(seed);
+  for (i = 0; i < matches; ++i) {
+    benchInfected(&results[0]);
+    benchKoth(&results[1]);
+    benchDomination(&results[2]);
+  }
+
+  printf("layout     |  raw | encoded avg  min  max | stored | encode ns | decode ns\n");
+  for (j = 0; j < 3; ++j) {
+    BenchResult_t * r = &results[j];
+    if (!r->Samples) continue;
+
+    printf("%-10s | %4d | %11.1f %4d %4d | %6d | %9.0f | %9.0f\n", r->Name, r->RawSize,
+      r->EncodedBytes / (double)r->Samples, r->EncodedMin, r->EncodedMax, r->Stored,
+      r->EncodeSeconds * 1e9 / r->Samples, r->DecodeSeconds * 1e9 / r->Samples);
+  }
+
+  if (Failures) {
+    printf("%d failures (seed %u)\n", Failures, seed);
+    return 1;
+  }
+
+  printf("ok: %d matches per layout, %d samples each (seed %u)\n", matches, matches * BENCH_MATCH_SECONDS, seed);
+  return 0;
+}
@@ -0,0 +1,148 @@
+/***************************************************
+ * FILENAME :		statsdecode.c
+ * DESCRIPTION :
+ * 		Reference decoder for the compact stats encoding written by
+ *    statsCompactEncode (common/statscompact.c). Reads an encoded upload and
+ *    writes the raw CustomGameModeStats payload.
+ *
+ *    gcc -O2 -o statsdecode statsdecode.c
+ *    ./statsdecode encoded.bin raw.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define STATS_COMPACT_HOST
+#include "../common/statscompact.h"
+
+#define STATS_MAX_SIZE              (1024 * 6)
+
+//--------------------------------------------------------------------------
+int getVarint(const uint8_t* src, int srcSize, int* pos, uint32_t* value)
+{
+  int shift = 0;
+  *value = 0;
+
+  while (*pos < srcSize && shift < 35) {
+    uint8_t b = src[(*pos)++];
+    *value |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      return 0;
+    shift += 7;
+  }
+
+  return -1;
+}
+
+//--------------------------------------------------------------------------
+// returns decoded size, or -1 if the input is malformed
+int statsCompactDecode(const uint8_t* src, int srcSize, uint8_t* dst, int dstSize)
+{
+  uint32_t size, token, value, dist;
+  int pos = 1, word = 0, i;
+
+  if (srcSize < 1 || (src[0] & ~STATS_COMPACT_STORED) != STATS_COMPACT_VERSION)
+    return -1;
+  if (getVarint(src, srcSize, &pos, &size) < 0 || size > (uint32_t)dstSize)
+    return -1;
+
+  // raw payload, written when the tokens weren't smaller
+  if (src[0] & STATS_COMPACT_STORED) {
+    if (size > (uint32_t)(srcSize - pos))
+      return -1;
+
+    memcpy(dst, src + pos, size);
+    return size;
+  }
+
+  int wordCount = (size + 3) / 4;
+  uint32_t words[STATS_MAX_SIZE / 4 + 1];
+  if (wordCount > (int)(sizeof(words) / sizeof(words[0])))
+    return -1;
+
+  while (word < wordCount) {
+    if (getVarint(src, srcSize, &pos, &token) < 0)
+      return -1;
+
+    uint32_t n = token >> 2;
+    if (n == 0 || n > (uint32_t)(wordCount - word))
+      return -1;
+
+    switch (token & 3)
+    {
+      case 0:
+      {
+        memset(&words[word], 0, n * 4);
+        break;
+      }
+      case 1:
+      {
+        for (i = 0; i < (int)n; ++i) {
+          if (getVarint(src, srcSize, &pos, &value) < 0)
+            return -1;
+          words[word + i] = (value >> 1) ^ -(value & 1);
+        }
+        break;
+      }
+      case 2:
+      {
+        if (getVarint(src, srcSize, &pos, &dist) < 0 || dist == 0 || dist > (uint32_t)word)
+          return -1;
+
+        // forward copy, runs may overlap
+        for (i = 0; i < (int)n; ++i)
+          words[word + i] = words[word + i - dist];
+        break;
+      }
+      default: return -1;
+    }
+
+    word += n;
+  }
+
+  for (i = 0; i < (int)size; ++i)
+    dst[i] = (words[i / 4] >> ((i % 4) * 8)) & 0xFF;
+
+  return size;
+}
+
+#ifndef STATS_DECODE_NO_MAIN
+//--------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  uint8_t src[STATS_MAX_SIZE * 2];
+  uint8_t dst[STATS_MAX_SIZE];
+
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s encoded.bin raw.bin\n", argv[0]);
+    return 1;
+  }
+
+  FILE* f = fopen(argv[1], "rb");
+  if (!f) {
+    perror(argv[1]);
+    return 1;
+  }
+  int srcSize = fread(src, 1, sizeof(src), f);
+  fclose(f);
+
+  int size = statsCompactDecode(src, srcSize, dst, sizeof(dst));
+  if (size < 0) {
+    fprintf(stderr, "%s: malformed stats\n", argv[1]);
+    return 1;
+  }
+
+  f = fopen(argv[2], "wb");
+  if (!f) {
+    perror(argv[2]);
+    return 1;
+  }
+  fwrite(dst, 1, size, f);
+  fclose(f);
+
+  printf("%d bytes -> %d bytes\n", srcSize, size);
+  return 0;
+}
+#endif // STATS_DECODE_NO_MAIN
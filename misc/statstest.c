@@ -0,0 +1,207 @@
+/***************************************************
+ * FILENAME :		statstest.c
+ * DESCRIPTION :
+ * 		Round-trip and fuzz tests for the compact stats encoding.
+ *    Encodes payloads with statsCompactEncode (common/statscompact.c),
+ *    decodes them with statsCompactDecode (misc/statsdecode.c) and
+ *    checks the bytes match, and that no payload grows past its stored
+ *    (raw) form. Then feeds mutated and random streams to the decoder,
+ *    which must reject or decode them in bounds.
+ *
+ *    gcc -O2 -fsanitize=address,undefined -o statstest statstest.c
+ *    ./statstest [iterations] [seed]
+ */
+
+#define STATS_DECODE_NO_MAIN
+#include "statsdecode.c"
+#include "../common/statscompact.c"
+
+#include <limits.h>
+
+#define STATS_ENCODED_MAX           (STATS_MAX_SIZE * 2)
+
+int Failures = 0;
+
+//--------------------------------------------------------------------------
+int roundTrip(const char * name, uint8_t * payload, int size)
+{
+  uint8_t encoded[STATS_ENCODED_MAX];
+  uint8_t decoded[STATS_MAX_SIZE];
+  int encodedSize, decodedSize;
+
+  encodedSize = statsCompactEncode(payload, size, encoded, sizeof(encoded));
+  if (encodedSize < 0) {
+    printf("FAIL %s: encode of %d bytes failed\n", name, size);
+    ++Failures;
+    return -1;
+  }
+
+  decodedSize = statsCompactDecode(encoded, encodedSize, decoded, sizeof(decoded));
+  if (decodedSize != size || memcmp(decoded, payload, size) != 0) {
+    printf("FAIL %s: %d bytes decoded to %d bytes\n", name, size, decodedSize);
+    ++Failures;
+    return -1;
+  }
+
+  // incompressible payloads fall back to the stored form, version + varint size + raw bytes
+  int storedSize = 1 + (size < (1 << 7) ? 1 : size < (1 << 14) ? 2 : 3) + size;
+  if (encodedSize > storedSize) {
+    printf("FAIL %s: %d bytes encoded to %d, stored is %d\n", name, size, encodedSize, storedSize);
+    ++Failures;
+    return -1;
+  }
+
+  // a destination one byte short must fail instead of overrunning
+  if (encodedSize > 1 && statsCompactEncode(payload, size, encoded, encodedSize - 1) >= 0) {
+    printf("FAIL %s: encode into %d bytes did not fail\n", name, encodedSize - 1);
+    ++Failures;
+    return -1;
+  }
+
+  return encodedSize;
+}
+
+//--------------------------------------------------------------------------
+void putWords(uint8_t * payload, int offset, const int * words, int count)
+{
+  memcpy(payload + offset, words, count * sizeof(int));
+}
+
+//--------------------------------------------------------------------------
+void testFixed(void)
+{
+  uint8_t payload[STATS_MAX_SIZE];
+  int i, size;
+  const int extremes[] = { INT_MIN, INT_MAX, -1, 1, 0, INT_MIN + 1, -64, 63, -65, 64 };
+
+  memset(payload, 0, sizeof(payload));
+  roundTrip("empty", payload, 0);
+  roundTrip("zeros", payload, sizeof(payload));
+
+  putWords(payload, 0, extremes, sizeof(extremes) / sizeof(extremes[0]));
+  roundTrip("extremes", payload, sizeof(extremes));
+
+  // every size around the word boundary
+  for (i = 0; i < 256; ++i)
+    payload[i] = (uint8_t)(i * 37 + 11);
+  for (size = 1; size <= 17; ++size)
+    roundTrip("unaligned", payload, size);
+
+  // per player blocks of kills, deaths, flags, the shape of a mode's stats
+  memset(payload, 0, sizeof(payload));
+  for (i = 0; i < 10; ++i) {
+    int player[] = { 12, -3, 0, 0, 1, 250 };
+    putWords(payload, i * sizeof(player), player, 6);
+  }
+  size = roundTrip("players", payload, 10 * 6 * sizeof(int));
+  if (size >= 0)
+    printf("players: %d -> %d bytes\n", 10 * 6 * (int)sizeof(int), size);
+
+  size = roundTrip("full", payload, sizeof(payload));
+  if (size >= 0)
+    printf("full: %d -> %d bytes\n", (int)sizeof(payload), size);
+
+  // worst case, incompressible
+  for (i = 0; i < (int)sizeof(payload); ++i)
+    payload[i] = rand();
+  size = roundTrip("noise", payload, sizeof(payload));
+  if (size >= 0)
+    printf("noise: %d -> %d bytes\n", (int)sizeof(payload), size);
+}
+
+//--------------------------------------------------------------------------
+void testRandom(int iterations)
+{
+  uint8_t payload[STATS_MAX_SIZE];
+  int i, j;
+
+  for (i = 0; i < iterations; ++i) {
+    int size = rand() % (i % 8 ? 512 : STATS_MAX_SIZE + 1);
+    int words = (size + 3) / 4;
+    memset(payload, 0, sizeof(payload));
+
+    // mix of zero runs, small values, negatives and repeats
+    for (j = 0; j < words; ++j) {
+      int value;
+      switch (rand() % 5)
+      {
+        case 0: value = 0; break;
+        case 1: value = rand() % 100; break;
+        case 2: value = -(rand() % 100); break;
+        case 3: value = j >= 8 ? ((int*)payload)[j - 1 - rand() % 8] : 0; break;
+        default: value = (int)(((uint32_t)rand() << 16) ^ (uint32_t)rand()); break;
+      }
+      memcpy(payload + j * 4, &value, 4);
+    }
+
+    // bytes past size must not leak into the stream
+    memset(payload + size, 0, sizeof(payload) - size);
+    if (roundTrip("random", payload, size) < 0)
+      return;
+  }
+}
+
+//--------------------------------------------------------------------------
+void testFuzzDecoder(int iterations)
+{
+  uint8_t payload[512];
+  uint8_t encoded[STATS_ENCODED_MAX];
+  uint8_t decoded[STATS_MAX_SIZE];
+  int i, j;
+
+  for (i = 0; i < iterations; ++i) {
+    int encodedSize, size;
+
+    if (i % 4 == 0) {
+      // pure noise, with a valid version byte most of the time
+      encodedSize = 1 + rand() % 64;
+      for (j = 0; j < encodedSize; ++j)
+        encoded[j] = rand();
+      if (i % 8)
+        encoded[0] = STATS_COMPACT_VERSION | (i % 3 ? 0 : STATS_COMPACT_STORED);
+    } else {
+      // a valid stream with a few flipped, truncated or dropped bytes
+      size = rand() % sizeof(payload);
+      for (j = 0; j < size; ++j)
+        payload[j] = rand() % 3 ? 0 : rand();
+      encodedSize = statsCompactEncode(payload, size, encoded, sizeof(encoded));
+      for (j = 1 + rand() % 3; j > 0 && encodedSize > 0; --j) {
+        switch (rand() % 3)
+        {
+          case 0: encoded[rand() % encodedSize] ^= 1 << (rand() % 8); break;
+          case 1: encodedSize = rand() % encodedSize; break;
+          default: encoded[rand() % encodedSize] = rand(); break;
+        }
+      }
+    }
+
+    // small destinations catch size checks that trust the header
+    int dstSize = i % 3 ? (int)sizeof(decoded) : rand() % 64;
+    size = statsCompactDecode(encoded, encodedSize, decoded, dstSize);
+    if (size > dstSize) {
+      printf("FAIL fuzz: decoded %d bytes into %d\n", size, dstSize);
+      ++Failures;
+      return;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+  unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+
+  srand(seed);
+  testFixed();
+  testRandom(iterations);
+  testFuzzDecoder(iterations * 10);
+
+  if (Failures) {
+    printf("%d failures (seed %u)\n", Failures, seed);
+    return 1;
+  }
+
+  printf("ok: %d round trips, %d fuzzed streams (seed %u)\n", iterations, iterations * 10, seed);
+  return 0;
+}
@@ -689,37 +689,29 @@ void healthbars_Logic(float nameX, float nameY, u32 nameColor, char * nameStr, i
 
 	// get the register and copy name into buff.
 	register u32 nameReg asm("s0");
-	char buff[15];
-	strncpy(buff, nameReg, 15);
+	char buff[PLAYER_ROSTER_NAME_LENGTH + 1];
+	strncpy(buff, nameReg, PLAYER_ROSTER_NAME_LENGTH);
+	buff[PLAYER_ROSTER_NAME_LENGTH] = 0;
+
+	// find nameplate owner
+	PlayerRoster_t * roster = playerGetRoster();
+	int i = playerRosterFindByName(buff);
+	if (i < 0 || !(roster->AliveMask & (1 << i)))
+		return;
 
-	int i;
-	Player ** players = playerGetAll();
-	GameSettings * gs = gameGetSettings();
-	int playercount = ((int)gs->PlayerCount - 1);
-	for(i = 0; i < GAME_MAX_PLAYERS; ++i) {
-		if (!players[i])
-			return;
-
-		// compare strings: if 0, strings match exactly.
-		int comp = strncmp(buff, gs->PlayerNames[i], 0x15);
-		if (!comp) {
-			Player * player = players[i];
-			int CurrentHealth = playerGetHealth(player);
-			if (CurrentHealth > 0 && !playerIsDead(player)) {
-				// printf("\ni: %d, buff: %s, health: %d", i, buff, CurrentHealth);
-				float x = (float)nameX;// / SCREEN_WIDTH;
-				float y = (float)nameY;// / SCREEN_HEIGHT;
-				float health = (float)((int)CurrentHealth / (int)PLAYER_MAX_HEALTH);
-				float w = (0.05 * 1) + 0.02;
-				float h = 0.02;
-				float p = 0.002;
-				float right = w * health;
-				x -= w / 2;
-				gfxScreenSpaceBox(x, y, w - p, h - p, 0x80000000);
-				gfxScreenSpaceBox(x, y, right, h, nameColor);
-			}
-		}
-	}
+	Player * player = roster->Players[i];
+	int CurrentHealth = playerGetHealth(player);
+	// printf("\ni: %d, buff: %s, health: %d", i, buff, CurrentHealth);
+	float x = (float)nameX;// / SCREEN_WIDTH;
+	float y = (float)nameY;// / SCREEN_HEIGHT;
+	float health = (float)((int)CurrentHealth / (int)PLAYER_MAX_HEALTH);
+	float w = (0.05 * 1) + 0.02;
+	float h = 0.02;
+	float p = 0.002;
+	float right = w * health;
+	x -= w / 2;
+	gfxScreenSpaceBox(x, y, w - p, h - p, 0x80000000);
+	gfxScreenSpaceBox(x, y, right, h, nameColor);
 }
 /*
  * NAME :		healthbars
@@ -1067,15 +1059,7 @@ void runCheckAllNodes(void) {
     char title[32];
     // get number of nodes and set timer value
     if (maxNodeCount == -1) {
-        maxNodeCount = 0;
-        Moby* mobyStart = mobyListGetStart();
-        Moby* mobyEnd = mobyListGetEnd();
-        while (mobyStart < mobyEnd) {
-            if (mobyStart->oClass == MOBY_ID_SIEGE_NODE) {
-                ++maxNodeCount;
-            }
-            ++mobyStart;
-        }
+        maxNodeCount = mobyClassCount(MOBY_ID_SIEGE_NODE);
     }
     // check which team each node is, and save it into nodes
     for (i = 0; i < maxNodeCount; ++i) {
@@ -8,6 +8,7 @@
 #include <libuya/gamesettings.h>
 #include <libuya/net.h>
 #include <libuya/map.h>
+#include <libuya/alloc.h>
 #include "config.h"
 #include "messageid.h"
 #include "include/config.h"
@@ -150,6 +151,7 @@ int mapsDownloadingModules(void);
 int mapReadCustomMapAuthorDescription(char* mapFilename, char dstAuthor[32], char dstDescription[256]);
 int mapReadCustomMapThumbnail(char* mapFilename, char *buf, int bufSize);
 void refreshCustomMapList(void);
+int customMapJumpLetter(int index, int direction);
 void sendClientVoteForEnd(void);
 
 extern int scavHuntEnabled;
@@ -1256,7 +1258,7 @@ void drawListVerticalMenuElementInfo(TabElem_t* tab, MenuElem_t* element, MenuEl
 
     // alloc thumbnail -- only in menus
     if (!mapOverrideSelectedMapThumbnail && isInMenus()) {
-      mapOverrideSelectedMapThumbnail = malloc(THUMBNAIL_SIZE);
+      mapOverrideSelectedMapThumbnail = allocTagged(ALLOC_TAG_PATCH, THUMBNAIL_SIZE);
     }
 
     // try read thumbnail
@@ -1403,6 +1405,16 @@ void drawLabelMenuElement(TabElem_t* tab, MenuElem_t* element, RECT* rect)
   gfxScreenSpaceText(x, y, 1, 1, colorLerp(colorText, 0, lerp), element->name, -1, 4, FONT_BOLD);
 }
 
+void listVerticalJumpLetter(MenuElem_ListData_t* listData, int direction)
+{
+  // item 0 is "None", maps follow in name order
+  char newValue = customMapJumpLetter(*listData->value - 1, direction) + 1;
+  char tValue = newValue;
+
+  if (listData->stateHandler == NULL || listData->stateHandler(listData, &tValue))
+    *listData->value = newValue;
+}
+
 void listVerticalInput(TabElem_t* tab)
 {
   int i;
@@ -1424,6 +1436,18 @@ void listVerticalInput(TabElem_t* tab)
     for (i = 0; i < 5; ++i)
       currentElement->handler(tab, currentElement, ACTIONTYPE_DECREMENT, NULL);
   }
+  // map list jump to next letter
+  else if (currentElement->userdata == &dataCustomMaps && padGetButtonUp(0, PAD_R2) > 0)
+  {
+    if (state & ELEMENT_EDITABLE)
+      listVerticalJumpLetter(&dataCustomMaps, 1);
+  }
+  // map list jump to previous letter
+  else if (currentElement->userdata == &dataCustomMaps && padGetButtonUp(0, PAD_L2) > 0)
+  {
+    if (state & ELEMENT_EDITABLE)
+      listVerticalJumpLetter(&dataCustomMaps, -1);
+  }
   // nav select secondary
   else if (padGetButtonDown(0, PAD_SQUARE) > 0)
   {
@@ -2091,7 +2115,10 @@ void drawFrame(void)
     if (state & ELEMENT_VISIBLE)
     {
       // get tab title width
-      float pWidth = (4 * tabBarPaddingX) + gfxGetFontWidth(tab->name, -1, 1) / (float)SCREEN_WIDTH;
+      // names never change so only measure once
+      if (tab->nameWidth <= 0)
+        tab->nameWidth = gfxGetFontWidth(tab->name, -1, 1) / (float)SCREEN_WIDTH;
+      float pWidth = (4 * tabBarPaddingX) + tab->nameWidth;
 
       // get color
       float lerp = state & ELEMENT_EDITABLE ? 0.0 : 0.5;
@@ -2173,10 +2200,11 @@ void drawTab(TabElem_t* tab)
   if (!tab)
     return;
 
-  static int helpLastItemIdx = -1;
+  static MenuElem_t* helpLastElement = NULL;
   static int helpItemCooldown1 = 0;
   static int helpItemCooldown2 = 0;
   static float helpLastXOffset = 0;
+  static float helpLastWidth = 0;
 
   int i = 0, state = 0;
   int menuElementRenderEnd = tab->menuOffset;
@@ -2220,8 +2248,10 @@ void drawTab(TabElem_t* tab)
         // draw help text
         if (currentElement->help && strlen(currentElement->help) > 0) {
 
-          if (i != helpLastItemIdx) {
-            helpLastItemIdx = i;
+          // measure help text once per selection
+          if (currentElement != helpLastElement) {
+            helpLastElement = currentElement;
+            helpLastWidth = gfxGetFontWidth(currentElement->help, -1, 1) / (float)SCREEN_WIDTH;
             helpLastXOffset = 0;
             helpItemCooldown1 = 60 * 3;
             helpItemCooldown2 = 60 * 6;
@@ -2237,8 +2267,7 @@ void drawTab(TabElem_t* tab)
             (frameY + frameH) * SCREEN_HEIGHT,
             (frameY + frameH + LINE_HEIGHT) * SCREEN_HEIGHT);
           
-          // get width
-          float w = gfxGetFontWidth(currentElement->help, -1, 1) / (float)SCREEN_WIDTH;
+          float w = helpLastWidth;
           if (helpItemCooldown1) --helpItemCooldown1;
           else if ((helpLastXOffset + w + contentPaddingX*2) >= frameW) helpLastXOffset -= 0.002;
           else if (helpItemCooldown2) --helpItemCooldown2;
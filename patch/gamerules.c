@@ -36,6 +36,8 @@ extern PatchPatches_t patched;
 extern PatchConfig_t lobbyPlayerConfigs[GAME_MAX_PLAYERS];
 extern PatchStateContainer_t patchStateContainer;
 
+void moduleEventPublish(int event, void * arg);
+
 int Gameplay_Hook = 0;
 int Gameplay_Func = 0;
 
@@ -134,6 +136,9 @@ u32 onGameplayLoad(void* a0, long a1)
 	if (gameConfig.grDestructableBridges)
 		onGameplayLoad_destructableBridges(gameplay);
 
+	// let subscribed modules edit the gameplay too
+	moduleEventPublish(MODULE_EVENT_GAMEPLAY_LOADED, gameplay);
+
 	// run base
 	((void (*)(void*, long))Gameplay_Func)(a0, a1);
 }
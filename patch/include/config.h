@@ -2,6 +2,7 @@
 #define __PATCH_CONFIG_H__
 
 #include "module.h"
+#include <libuya/alloc.h>
 
 #define MAX_CUSTOM_MAP_DEFINITIONS              (100) // max: 600
 
@@ -109,6 +110,7 @@ typedef struct TabElem
   int elementsCount;
   int selectedMenuItemIdx;
   int menuOffset;
+  float nameWidth; // cached title width, measured on first draw
 } TabElem_t;
 
 typedef struct CustomMapVersionFileDef {
@@ -131,6 +133,37 @@ enum MapLoaderLoaded {
   MAPLOADED_SOUND_SENT = 8,
 };
 
+enum MapLoaderSoundLoad {
+  SOUNDLOAD_IDLE = 0,
+  SOUNDLOAD_WAIT_RPC = 1,   // waiting for the sound rpc client to free up
+  SOUNDLOAD_IN_FLIGHT = 2,  // bank upload issued, waiting for the iop
+};
+
+enum MapLoaderPrefetchSegment {
+  PREFETCH_SOUND = 0,
+  PREFETCH_LEVEL = 1,
+  PREFETCH_GAMEPLAY = 2,
+  PREFETCH_COUNT = 3,
+};
+
+// segments read into memory while in staging, served to the load hooks
+#define MAP_PREFETCH_BLOCK_SIZE                 (64 * 1024)
+#define MAP_PREFETCH_MAX_BLOCKS                 (64)
+
+struct MapLoaderPrefetch {
+    char MapFileName[128]; // selection the blocks were read for
+    AllocPool_t Pool; // sized once per selection for every segment
+    void * Blocks[MAP_PREFETCH_MAX_BLOCKS]; // in read order, NULL once served
+    int BlockCount;
+    int FirstBlock[PREFETCH_COUNT];
+    int Sizes[PREFETCH_COUNT];
+    int Read[PREFETCH_COUNT];
+    int Segment; // segment being read, PREFETCH_COUNT when done or stopped
+    int Fd;
+    int Pending; // a read was issued and hasn't been synced yet
+    int Served; // a load hook was just served from a buffer
+};
+
 struct MapLoaderState {
     u8 Enabled;
     u8 MapId;
@@ -147,6 +180,11 @@ struct MapLoaderState {
     void * SoundBuffer;
     SndCompleteProc SoundLoadCb;
     u64 SoundLoadUserData;
+    int SoundLoadState;
+    long SoundLoadStartTime;
+    void * SoundBank; // copy of the bank the iop uploads from, freed once it's done
+    int SoundBankSize;
+    struct MapLoaderPrefetch Prefetch;
 };
 
 typedef struct VoteToEndState {
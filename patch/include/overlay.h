@@ -0,0 +1,42 @@
+#ifndef __PATCH_OVERLAY_H__
+#define __PATCH_OVERLAY_H__
+
+#include <tamtypes.h>
+
+#define OVERLAY_MAGIC                           (0x4C564F48) // HOVL
+#define OVERLAY_MAX_EXPORTS                     (8)
+
+#if UYA_PAL
+#define OVERLAY_UI_FILENAME                     "ovl-ui-10683.bin"
+#else
+#define OVERLAY_UI_FILENAME                     "ovl-ui-10684.bin"
+#endif
+
+enum OverlayId
+{
+  OVERLAY_NONE = 0,
+  OVERLAY_UI = 1,
+};
+
+enum OverlayUiExport
+{
+  OVERLAY_UI_EXPORT_STAGING = 0,
+  OVERLAY_UI_EXPORT_KEYBOARD = 1,
+};
+
+// first bytes of every overlay, linked at OVERLAY_WINDOW (regions.ld)
+typedef struct OverlayHeader
+{
+  u32 Magic;
+  int Id;
+  u32 Size;
+  u32 PatchEnd;       // SECTION_PATCH_END of the patch the overlay was linked against
+  void * Exports[OVERLAY_MAX_EXPORTS];
+} OverlayHeader_t;
+
+int overlayLoad(int id);
+void overlayUnload(void);
+int overlayGetLoadedId(void);
+void * overlayGetExport(int index);
+
+#endif // __PATCH_OVERLAY_H__
@@ -14,6 +14,7 @@
 #include <libuya/gamesettings.h>
 #include <libuya/pad.h>
 #include <libuya/stdio.h>
+#include <libuya/alloc.h>
 #include <libuya/uya.h>
 #include <libuya/math3d.h>
 #include <libuya/ui.h>
@@ -39,6 +40,7 @@
 #define GLOBAL_GAME_MODULES_START							((GameModule*)0x000cf000)
 #define EXCEPTION_HANDLER									(0x000c8000)
 #define GAME_UPDATE_SENDRATE								(5 * TIME_SECOND)
+#define GAME_UPDATE_KEEPALIVE								(15 * TIME_SECOND)
 
 #if UYA_PAL
 #define STAGING_START_BUTTON_STATE							(*(short*)0x006c2d80)
@@ -91,10 +93,33 @@ void grLoadStart(void);
 #ifdef SCAVENGER_HUNT
 void scavHuntRun(void);
 #endif
+#ifdef NET_RECORD
+void netRecordTick(void);
+#endif
+#ifdef STATS_COMPACT
+#include "statscompact.h"
+#endif
+void moduleEventTick(void);
+void moduleEventInvoke(GameModule * module, ModuleStart entrypoint);
+int moduleEventSubscribe(GameModule * module, u32 eventMask, ModuleEventHandler_f handler);
+#ifdef DEBUG
+void moduleEventPrintTimings(void);
+void playerSyncPrintStats(void);
+#endif
+#ifdef UI_OVERLAY
+#include "overlay.h"
+
+u32 overlayUiBaseStaging = 0;
+u32 overlayUiBaseKeyboard = 0;
+#endif
 
 int hasInitialized = 0;
 int lastMenuInvokedTime = 0;
 int lastGameState = 0;
+#ifdef DEBUG
+int allocUsagePending = 0;
+int hasRunBatchSelfTest = 0;
+#endif
 int sentGameStart = 0;
 int isInStaging = 0;
 int location = LOCATION_NULL;
@@ -181,6 +206,7 @@ PatchPointers_t patchPointers = {
   .ServerTimeHour = 0,
   .ServerTimeMinute = 0,
   .ServerTimeSecond = 0,
+  .ModuleEventSubscribe = &moduleEventSubscribe,
 };
 
 #if DSCRPRINT
@@ -1450,7 +1476,9 @@ void customFlagLogic(Moby* flagMoby)
 {
 	VECTOR t;
 	int i;
-	Player** players = playerGetAll();
+	PlayerRoster_t* roster = playerGetRoster();
+	Player** players = roster->Players;
+	float sqrDistances[GAME_MAX_PLAYERS];
 	int gameTime = gameGetTime();
 	GameOptions* gameOptions = gameGetOptions();
 	flagPVars_t* pvars = (flagPVars_t*)flagMoby->pVar;
@@ -1476,6 +1504,9 @@ void customFlagLogic(Moby* flagMoby)
 		return;
 	}
 
+	// distance from every player to the flag
+	vector_sqrdist_batch(sqrDistances, roster->Positions, GAME_MAX_PLAYERS, flagMoby->position);
+
     for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
         Player* player = players[i];
         if (!player)
@@ -1503,9 +1534,7 @@ void customFlagLogic(Moby* flagMoby)
 			continue;
 
 		// player must be within 2 units of flag
-		vector_subtract(t, flagMoby->position, player->playerPosition);
-		float sqrDistance = vector_sqrmag(t);
-		if (sqrDistance > (2*2))
+		if (sqrDistances[i] > (2*2))
 			continue;
 
 		if (!flagPickupDelayReady(flagMoby, pvars, player, gameTime))
@@ -1657,6 +1686,162 @@ void patchQuickSelectTimer(void)
 	}
 }
 
+#define CAMPAIGN_MUSIC_SECTOR		(0x1d8a)
+#define CAMPAIGN_MUSIC_TRACKS		((u32*)0x001f8588) // Overwrites current tracks too.
+#define CAMPAIGN_MUSIC_STACK		(0x000269300)
+#define CAMPAIGN_MUSIC_MAX_TRACKS	(64)
+
+// We go by each wad because we have to have Multiplayer one first.
+static short campaignMusicWads[][2] = {
+	// wad, song per wad
+	// Commented tracks/sectors are due to them being dialoge or messed up.
+	{0x54d, 14}, // Multiplayer
+	{0x3f9, 2}, // Veldin
+	{0x403, 4}, // Florana
+	{0x40d, 3}, // Starship Phoenix
+	{0x417, 3}, // Marcadia
+	{0x421, 4}, // Daxx (This doesn't have padding between music and dialog)
+	{0x42b, 1}, // 
+	{0x435, 4}, // Annihilation Nation
+	{0x43f, 1}, // Aquatos
+	{0x449, 1}, // Tyhrranosis
+	{0x453, 1}, // Zeldrin Starport
+	{0x45d, 1}, // Obani Gemini
+	{0x467, 1}, // Blackwater City
+	{0x471, 2}, // Holostar Studios
+	{0x47b, 1}, // Koros
+	{0x485, 1}, // Metropolis
+	{0x48f, 1}, // Crash Site
+	{0x499, 1}, // Aridia
+	{0x4a3, 1}, // Quark's Hideout
+	{0x4ad, 1}, // Mylon - Bioliterator
+	{0x4b7, 2}, // Obani Draco
+	{0x4c1, 1}, // Mylon - Command Center
+	{0x4cb, 1}, // 
+	{0x4d5, 1}, // Insomniac Museum
+	// {0x4df, 0}, // 
+	{0x4e9, 1}, // 
+	{0x4f3, 1}, // 
+	{0x4fd, 1}, // 
+	{0x507, 1}, //
+	{0x511, 1}, // 
+	{0x51b, 1}, // 
+	{0x525, 1}, // 
+	{0x52f, 1}, // 
+	{0x539, 1}, // 
+	{0x543, 1}  // 
+};
+
+// Converted tracks, built once per session and kept across games.
+struct CampaignMusicTable {
+	int DiscKey; // multiplayer wad sector the table was built against
+	int WadIndex; // next wad to convert
+	int TotalTracks;
+	int Ready;
+	int Applied;
+	u32 Tracks[CAMPAIGN_MUSIC_MAX_TRACKS][2]; // left, right
+} CampaignMusicTable = {0};
+
+/*
+ * NAME :		campaignMusicGetWadSectors
+ * DESCRIPTION :	Reads a wad's sector table into the scratch stack.
+ * NOTES :
+ * ARGS : 
+ * RETURN :			The wad's sector.
+ * AUTHOR :			Troy "Metroynome" Pruitt
+ */
+int campaignMusicGetWadSectors(int wad)
+{
+	memset((u32*)CAMPAIGN_MUSIC_STACK, 0, 0x1818);
+	internal_wadGetSectors(wad, 1, CAMPAIGN_MUSIC_STACK);
+	return *(u32*)(CAMPAIGN_MUSIC_STACK + 0x4);
+}
+
+/*
+ * NAME :		campaignMusicConvertNextWad
+ * DESCRIPTION :	Converts the next wad's tracks into the table.
+ * NOTES :			One wad per call so the lookups are spread across frames.
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Troy "Metroynome" Pruitt
+ */
+void campaignMusicConvertNextWad(void)
+{
+	struct CampaignMusicTable* table = &CampaignMusicTable;
+	int a = table->WadIndex++;
+	int j;
+
+	if (a >= (sizeof(campaignMusicWads)/sizeof(campaignMusicWads[0]))) {
+		table->Ready = 1;
+		return;
+	}
+
+	int WAD = campaignMusicWads[a][0];
+	int WAD_Sector = campaignMusicGetWadSectors(WAD);
+
+	// the multiplayer wad identifies the disc
+	if (a == 0)
+		table->DiscKey = WAD_Sector;
+
+	// make sure WAD_Sector isn't zero
+	if (WAD_Sector != 0) {
+		DPRINTF("WAD: 0x%X\n", WAD);
+		DPRINTF("WAD Sector: 0x%X\n", WAD_Sector);
+
+		// do music stuffs~
+		// Get SP 2 MP Offset for current WAD_Sector.
+		// In UYA we use our own sector.
+		int SP2MP = WAD_Sector - CAMPAIGN_MUSIC_SECTOR;
+		// Remember we skip the first track because it is the start of the sp track, not the body of it.
+		int b = 0;
+		int Songs = CAMPAIGN_MUSIC_STACK + (a == 0 ? 0x8 : 0x18);
+		for (j = 0; j < campaignMusicWads[a][1] && table->TotalTracks < CAMPAIGN_MUSIC_MAX_TRACKS; ++j) {
+			int Track_LeftAudio = *(u32*)(Songs + b);
+			int Track_RightAudio = *(u32*)((u32)(Songs + b) + 0x8);
+			table->Tracks[table->TotalTracks][0] = (u32)(SP2MP + Track_LeftAudio);
+			table->Tracks[table->TotalTracks][1] = (u32)(SP2MP + Track_RightAudio);
+			b += (a == 0) ? 0x10 : 0x20;
+			++table->TotalTracks;
+		}
+	}
+
+	// Zero out stack to finish the job.
+	memset((u32*)CAMPAIGN_MUSIC_STACK, 0, 0x1818);
+}
+
+/*
+ * NAME :		campaignMusicApply
+ * DESCRIPTION :	Copies the converted tracks into the game's track table.
+ * NOTES :			Rebuilds the table if the disc no longer matches.
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Troy "Metroynome" Pruitt
+ */
+void campaignMusicApply(void)
+{
+	struct CampaignMusicTable* table = &CampaignMusicTable;
+	int i;
+
+	// validate
+	int discKey = campaignMusicGetWadSectors(campaignMusicWads[0][0]);
+	memset((u32*)CAMPAIGN_MUSIC_STACK, 0, 0x1818);
+	if (discKey != table->DiscKey) {
+		DPRINTF("campaign music disc changed, rebuilding\n");
+		memset(table, 0, sizeof(struct CampaignMusicTable));
+		return;
+	}
+
+	if (musicGetSector() != CAMPAIGN_MUSIC_SECTOR)
+		musicSetSector(CAMPAIGN_MUSIC_SECTOR);
+
+	for (i = 0; i < table->TotalTracks; ++i) {
+		CAMPAIGN_MUSIC_TRACKS[(i * 4) + 0] = table->Tracks[i][0];
+		CAMPAIGN_MUSIC_TRACKS[(i * 4) + 2] = table->Tracks[i][1];
+	}
+
+	table->Applied = 1;
+}
+
 /*
  * NAME :		runCampaignMusic
  * DESCRIPTION :	Adds Singple Player Tracks to Multiplayer
@@ -1667,51 +1852,12 @@ void patchQuickSelectTimer(void)
  */
 void runCampaignMusic(void)
 {
-	static int FinishedConvertingTracks = 0;
-	static int TotalTracks = 0;
 	static short CurrentTrack = -1;
 	static short NextTrack = -1;
+	static int WasInGame = 0;
 	int DefaultMultiplayerTracks = 13;
-	// We go by each wad because we have to have Multiplayer one first.
-	static short wadArray[][2] = {
-		// wad, song per wad
-		// Commented tracks/sectors are due to them being dialoge or messed up.
-		{0x54d, 14}, // Multiplayer
-		{0x3f9, 2}, // Veldin
-		{0x403, 4}, // Florana
-		{0x40d, 3}, // Starship Phoenix
-		{0x417, 3}, // Marcadia
-		{0x421, 4}, // Daxx (This doesn't have padding between music and dialog)
-		{0x42b, 1}, // 
-		{0x435, 4}, // Annihilation Nation
-		{0x43f, 1}, // Aquatos
-		{0x449, 1}, // Tyhrranosis
-		{0x453, 1}, // Zeldrin Starport
-		{0x45d, 1}, // Obani Gemini
-		{0x467, 1}, // Blackwater City
-		{0x471, 2}, // Holostar Studios
-		{0x47b, 1}, // Koros
-		{0x485, 1}, // Metropolis
-		{0x48f, 1}, // Crash Site
-		{0x499, 1}, // Aridia
-		{0x4a3, 1}, // Quark's Hideout
-		{0x4ad, 1}, // Mylon - Bioliterator
-		{0x4b7, 2}, // Obani Draco
-		{0x4c1, 1}, // Mylon - Command Center
-		{0x4cb, 1}, // 
-		{0x4d5, 1}, // Insomniac Museum
-		// {0x4df, 0}, // 
-		{0x4e9, 1}, // 
-		{0x4f3, 1}, // 
-		{0x4fd, 1}, // 
-		{0x507, 1}, //
-		{0x511, 1}, // 
-		{0x51b, 1}, // 
-		{0x525, 1}, // 
-		{0x52f, 1}, // 
-		{0x539, 1}, // 
-		{0x543, 1}  // 
-	};
+	int TotalTracks = CampaignMusicTable.TotalTracks;
+	int InGame = isInGame();
 
 	#if UYA_PAL
 	int CodeSegmentCheck = *(u32*)0x01FFFD00 == 0x00575CC8;
@@ -1721,65 +1867,19 @@ void runCampaignMusic(void)
 	if (!musicGetSector() || CodeSegmentCheck)
 		return;
 	
-	if (config.enableSingleplayerMusic) {
-		if (!FinishedConvertingTracks) {
-			int CustomSector = 0x1d8a;
-			u32 NewTracksLocation = 0x001f8588; // Overwrites current tracks too.
-			if (musicGetSector() != CustomSector)
-				musicSetSector(CustomSector);
-
-			int MultiplayerSector = *(u32*)0x001F8584;
-			int Stack = 0x000269300;
-			// int WAD_Table = 0x001f7f88; // Kept for historical purposes.
-			int a;
-			memset((u32*)Stack, 0, 0x1818);
-
-			// Loop through each WAD ID
-			for(a = 0; a < (sizeof(wadArray)/sizeof(wadArray[0])); a++) {
-				int WAD = wadArray[a][0];
-				// Check if Map Sector is not zero
-				if (WAD != 0) {
-					internal_wadGetSectors(WAD, 1, Stack);
-					int WAD_Sector = *(u32*)(Stack + 0x4);
-
-					// make sure WAD_Sector isn't zero
-					if (WAD_Sector != 0) {
-						DPRINTF("WAD: 0x%X\n", WAD);
-						DPRINTF("WAD Sector: 0x%X\n", WAD_Sector);
-
-						// do music stuffs~
-						// Get SP 2 MP Offset for current WAD_Sector.
-						// In UYA we use our own sector.
-						int SP2MP = WAD_Sector - CustomSector;
-						// Remember we skip the first track because it is the start of the sp track, not the body of it.
-						int b = 0;
-						int Songs = Stack + (a == 0 ? 0x8 : 0x18);
-						int j;
-						for (j = 0; j < wadArray[a][1]; ++j) {
-							int Track_LeftAudio = *(u32*)(Songs + b);
-							int Track_RightAudio = *(u32*)((u32)(Songs + b) + 0x8);
-							int ConvertedTrack_LeftAudio = SP2MP + Track_LeftAudio;
-							int ConvertedTrack_RightAudio = SP2MP + Track_RightAudio;
-							*(u32*)(NewTracksLocation) = (u32)ConvertedTrack_LeftAudio;
-							*(u32*)(NewTracksLocation + 0x8) = (u32)ConvertedTrack_RightAudio;
-							NewTracksLocation += 0x10;
-							b += (a == 0) ? 0x10 : 0x20;
-							++TotalTracks;
-						}
-					}
-				}
-				// Zero out stack to finish the job.
-				memset((u32*)Stack, 0, 0x1818);
-				
-				FinishedConvertingTracks = 1;
-			}
-		}
+	// convert in the background, but only copy the table in once per game
+	if (config.enableSingleplayerMusic && !CampaignMusicTable.Applied) {
+		if (!CampaignMusicTable.Ready)
+			campaignMusicConvertNextWad();
+		else if (InGame)
+			campaignMusicApply();
 	}
 
 	// If in game
-	if (isInGame()) {
+	if (InGame) {
+		WasInGame = 1;
 		music_Globals* music = musicGetGlobals();
-		if (config.enableSingleplayerMusic) {
+		if (config.enableSingleplayerMusic && CampaignMusicTable.Applied) {
 			if (*(int*)musicTrackRangeMax() != (TotalTracks - 4) || *(int*)musicTrackRangeMin() != 4) {
 				*(int*)musicTrackRangeMin() = 4;
 				*(int*)musicTrackRangeMax() = TotalTracks - 4;
@@ -1814,9 +1914,10 @@ void runCampaignMusic(void)
 		int randomTrackButton = padGetButtonDown(0, PAD_UP | PAD_R3) > 0;
 		if (randomTrackButton)
 			music->play.status = MUSIC_STATUS_PLAY_NEXT;
-	} else if (isInMenus() && FinishedConvertingTracks) {
-		FinishedConvertingTracks = 0;
-		TotalTracks = 0;
+	} else if (WasInGame) {
+		// keep the converted table, only the copy is redone next game
+		WasInGame = 0;
+		CampaignMusicTable.Applied = 0;
 		CurrentTrack = -1;
 		NextTrack = -1;
 	}
@@ -2740,10 +2841,41 @@ void setupPatchConfigInGame(void)
 	}
 }
 
+/*
+ * NAME :		getGameStateNodeCounts
+ * DESCRIPTION : Counts the nodes owned by each team.
+ * NOTES : Node ownership only changes on capture, so counts are cached
+ *         against a snapshot of nodeTeam and only recounted when it differs.
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Troy "Metroynopme" Pruitt
+ */
+void getGameStateNodeCounts(GameData * gameData, int * nodes)
+{
+	static int lastNodeTeam[8] = {-2,-2,-2,-2,-2,-2,-2,-2};
+	static int cachedNodes[2] = {0,0};
+	int i;
+
+	if (memcmp(lastNodeTeam, gameData->allYourBaseGameData->nodeTeam, sizeof(lastNodeTeam)) != 0) {
+		cachedNodes[0] = cachedNodes[1] = 0;
+		for (i = 0; i < 8; ++i) {
+			lastNodeTeam[i] = gameData->allYourBaseGameData->nodeTeam[i];
+			if (lastNodeTeam[i] == 0)
+				++cachedNodes[0];
+			else if (lastNodeTeam[i] == 1)
+				++cachedNodes[1];
+		}
+	}
+
+	nodes[0] = cachedNodes[0];
+	nodes[1] = cachedNodes[1];
+}
+
 /*
  * NAME :		runSendGameUpdate
  * DESCRIPTION : Sends the current game info to the server.
- * NOTES :
+ * NOTES : The state is rebuilt at most every GAME_UPDATE_SENDRATE and skipped
+ *         when its fingerprint is unchanged, up to GAME_UPDATE_KEEPALIVE.
  * ARGS : 
  * RETURN :
  * AUTHOR :			Troy "Metroynopme" Pruitt
@@ -2751,6 +2883,8 @@ void setupPatchConfigInGame(void)
 int runSendGameUpdate(void)
 {
 	static int lastGameUpdate = 0;
+	static int lastGameUpdateSent = 0;
+	static u32 lastFingerprint = 0;
 	static int newGame = 0;
 	GameSettings * gameSettings = gameGetSettings();
 	GameOptions * gameOptions = gameGetOptions();
@@ -2763,6 +2897,7 @@ int runSendGameUpdate(void)
 	// skip if not online, in lobby, or the game host
 	if (!connection || !gameSettings || !gameAmIHost()) {
 		lastGameUpdate = -GAME_UPDATE_SENDRATE;
+		lastGameUpdateSent = -GAME_UPDATE_KEEPALIVE;
 		newGame = 1;
 		return 0;
 	}
@@ -2784,6 +2919,7 @@ int runSendGameUpdate(void)
 	// reset some stuff whenever we enter a new game
 	if (newGame) {
 		memset(patchStateContainer.GameStateUpdate.TeamScores, 0, sizeof(patchStateContainer.GameStateUpdate.TeamScores));
+		lastGameUpdateSent = -GAME_UPDATE_KEEPALIVE;
 		newGame = 0;
 	}
 
@@ -2798,12 +2934,7 @@ int runSendGameUpdate(void)
 		// memset(patchStateContainer.GameStateUpdate.Nodes, 0, sizeof(patchStateContainer.GameStateUpdate.Nodes));
 
 		if (gameSettings->GameType == GAMETYPE_SIEGE) {	
-			for (i = 0; i < 8; ++i) {
-				if (gameData->allYourBaseGameData->nodeTeam[i] == 0)
-					++patchStateContainer.GameStateUpdate.Nodes[0];
-				else if (gameData->allYourBaseGameData->nodeTeam[i] == 1)
-					++patchStateContainer.GameStateUpdate.Nodes[1];
-			}
+			getGameStateNodeCounts(gameData, patchStateContainer.GameStateUpdate.Nodes);
 			patchStateContainer.GameStateUpdate.TeamScores[0] = gameData->allYourBaseGameData->hudHealth[0];
 			patchStateContainer.GameStateUpdate.TeamScores[1] = gameData->allYourBaseGameData->hudHealth[1];
 		} else if (gameSettings->GameType == GAMETYPE_CTF) {
@@ -2812,12 +2943,7 @@ int runSendGameUpdate(void)
 			patchStateContainer.GameStateUpdate.Nodes[1] = -1;
 			// Check if nodes are on
 			if (gameOptions->GameFlags.MultiplayerGameFlags.Nodes) {
-				for (i = 0; i < 8; ++i) {
-					if (gameData->allYourBaseGameData->nodeTeam[i] == 0)
-						++patchStateContainer.GameStateUpdate.Nodes[0];
-					else if (gameData->allYourBaseGameData->nodeTeam[i] == 1)
-						++patchStateContainer.GameStateUpdate.Nodes[1];
-				}	
+				getGameStateNodeCounts(gameData, patchStateContainer.GameStateUpdate.Nodes);
 			}
 			patchStateContainer.GameStateUpdate.TeamScores[0] = gameData->CTFGameData->blueTeamCaptures;
 			patchStateContainer.GameStateUpdate.TeamScores[1] = gameData->CTFGameData->redTeamCaptures;
@@ -2830,9 +2956,61 @@ int runSendGameUpdate(void)
 			}
 		}
 	}
+
+	u32 fingerprint = fnv1a(&patchStateContainer.GameStateUpdate, sizeof(UpdateGameStateRequest_t));
+
+	// only send on change or keepalive
+	if (fingerprint == lastFingerprint && (gameTime - lastGameUpdateSent) < GAME_UPDATE_KEEPALIVE)
+		return 0;
+
+	lastFingerprint = fingerprint;
+	lastGameUpdateSent = gameTime;
 	return 1;
 }
 
+#ifdef STATS_COMPACT
+/*
+ * NAME :		runCompactGameStats
+ * DESCRIPTION :
+ * 			Encodes the custom game stats a module wrote with statsCompactEncode.
+ * NOTES :
+ * 			Modules write raw stats every frame the server asks for them.
+ * 			The encoded payload is fingerprinted so it isn't encoded twice.
+ * ARGS : 
+ * RETURN :
+ * AUTHOR :			Daniel "Dnawrkshp" Gerendasy
+ */
+void runCompactGameStats(void)
+{
+	static u32 lastFingerprint = 0;
+	u8* payload = patchStateContainer.CustomGameStats.Payload;
+	int size = patchStateContainer.CustomGameStatsSize;
+
+	if (!patchStateContainer.UpdateCustomGameStats || size <= 0 || size > sizeof(CustomGameModeStats_t))
+		return;
+
+	// nothing new since the last encode
+	u32 fingerprint = fnv1a(payload, size);
+	if (fingerprint == lastFingerprint)
+		return;
+
+	lastFingerprint = fingerprint;
+	u8* encoded = allocTagged(ALLOC_TAG_PATCH, sizeof(CustomGameModeStats_t));
+	if (!encoded)
+		return;
+
+	// incompressible stats are stored, which only fits if there's room for the header
+	size = statsCompactEncode(payload, size, encoded, sizeof(CustomGameModeStats_t));
+	if (size > 0) {
+		memcpy(payload, encoded, size);
+		patchStateContainer.CustomGameStatsSize = size;
+		lastFingerprint = fnv1a(payload, size);
+	}
+
+	freeTagged(encoded);
+}
+#endif
+
 /*
  * NAME :		processGameModules
  * DESCRIPTION :
@@ -2849,6 +3027,9 @@ void processGameModules()
 	// Game settings
 	GameSettings * gamesettings = gameGetSettings();
 
+	// Publish events to subscribed modules
+	moduleEventTick();
+
 	// Iterate through all the game modules until we hit an empty one
 	while (module->GameEntrypoint || module->LobbyEntrypoint) {
 		// Ensure we have game settings
@@ -2859,11 +3040,11 @@ void processGameModules()
 				if (isInGame()) {
 					// Invoke module
 					if (module->GameEntrypoint)
-						module->GameEntrypoint(module, &config, &gameConfig);
+						moduleEventInvoke(module, module->GameEntrypoint);
 				} else if (isInMenus()) {
 					// Invoke lobby module if still active
 					if (module->LobbyEntrypoint) {
-						module->LobbyEntrypoint(module, &config, &gameConfig);
+						moduleEventInvoke(module, module->LobbyEntrypoint);
 					}
 				}
 			}
@@ -2875,7 +3056,7 @@ void processGameModules()
 		} else if (module->State == GAMEMODULE_ALWAYS_ON) {
 			// Invoke lobby module if still active
 			if (isInMenus() && module->LobbyEntrypoint) {
-				module->LobbyEntrypoint(module, &config, &gameConfig);
+				moduleEventInvoke(module, module->LobbyEntrypoint);
 			}
 		}
 
@@ -2980,6 +3161,11 @@ int main(void)
 	// update patch pointers
 	PATCH_POINTERS = &patchPointers;
 
+	#ifdef DEBUG
+	// poison freed heap, pool and arena memory so use after free shows up
+	allocSetPoison(1);
+	#endif
+
 	// auto enable pad input to prevent freezing when popup shows
 	if (isInMenus() && lastMenuInvokedTime > 0 && (gameGetTime() - lastMenuInvokedTime) > TIME_SECOND) {
 		padEnableInput();
@@ -3013,6 +3199,11 @@ int main(void)
 	scavHuntRun();
 	#endif
 
+	#ifdef NET_RECORD
+	// Record custom messages for offline replay
+	netRecordTick();
+	#endif
+
 	// Run Send Gameupdate for Helga
 	patchStateContainer.UpdateGameState = runSendGameUpdate();
 
@@ -3030,7 +3221,8 @@ int main(void)
 	if (!isInGame()) {
 		mpMoby = NULL;
 	} else if (!mpMoby) {
-		mpMoby = mobyFindNextByOClass(mobyListGetStart(), 0x106A);
+		MobyClassIterator_t it;
+		mpMoby = mobyClassIterBegin(&it, MOBY_ID_MP_PLAYER_CONFIG);
 		if (mpMoby) {
 			DPRINTF("mpmoby hooked!: %08x\n", mpMoby);
 			mpMoby->pUpdate = &onMobyUpdate;
@@ -3153,6 +3345,17 @@ int main(void)
 		if (lastGameState != 1)
 			configMenuDisable();
 
+		#ifdef UI_OVERLAY
+		// menu ui patches live in the overlay window
+		// give the game its handlers back and evict them
+		if (patched.uiModifiers) {
+			POKE_U32(UI_PTR_FUNC_STAGING, overlayUiBaseStaging);
+			POKE_U32(UI_PTR_FUNC_KEYBOARD, overlayUiBaseKeyboard);
+			patched.uiModifiers = 0;
+		}
+		overlayUnload();
+		#endif
+
 		// Updates Start Menu to have "Patch Config" option.
 		// Logic for opening menu as well.
 		setupPatchConfigInGame();
@@ -3160,17 +3363,47 @@ int main(void)
 		// trigger config menu update
 		onConfigGameMenu();
 
+		#ifdef DEBUG
+		allocUsagePending = 1;
+
+		// check the vu0 batch kernels against their c references once
+		if (!hasRunBatchSelfTest) {
+			vector_batch_selftest();
+			hasRunBatchSelfTest = 1;
+		}
+		#endif
+
 		lastGameState = 1;
 	} else if (isInMenus()) {
 		// If in Lobby, run these game rules.
 		grLobbyStart();
 
+		#ifdef DEBUG
+		// heap usage per subsystem and module timings after each match
+		if (allocUsagePending) {
+			allocPrintUsage();
+			moduleEventPrintTimings();
+			playerSyncPrintStats();
+			allocUsagePending = 0;
+		}
+		#endif
+
 		// Patches loading popup from not showing if patch menu is open.
 		patchLoadingPopup();
 
 		playerSyncTick();
 		
 		// Patch Menus (Staging, create game, ect.)
+		#ifdef UI_OVERLAY
+		if (patched.uiModifiers == 0 && overlayLoad(OVERLAY_UI)) {
+			overlayUiBaseStaging = *(u32*)UI_PTR_FUNC_STAGING;
+			overlayUiBaseKeyboard = *(u32*)UI_PTR_FUNC_KEYBOARD;
+			POKE_U32(UI_PTR_FUNC_STAGING, (u32)overlayGetExport(OVERLAY_UI_EXPORT_STAGING));
+			POKE_U32(UI_PTR_FUNC_KEYBOARD, (u32)overlayGetExport(OVERLAY_UI_EXPORT_KEYBOARD));
+			POKE_U32(STAGING_JALR_HEADSET_SET_COLOR, 0);
+			patched.uiModifiers = 1;
+		}
+		#else
 		if (patched.uiModifiers == 0) {
 			// POKE_U32(UI_PTR_FUNC_CREATE_GAME, &patchCreateGame);
 			// POKE_U32(UI_PTR_FUNC_ADVANCED_OPTIONS, &patchAdvancedOptions);
@@ -3182,6 +3415,7 @@ int main(void)
 			POKE_U32(STAGING_JALR_HEADSET_SET_COLOR, 0);
 			patched.uiModifiers = 1;
 		}
+		#endif
 
 		// Patch Rank Table
 		if (!patched.rankTable) {
@@ -3249,6 +3483,11 @@ int main(void)
 	// process modules
 	processGameModules();
 
+	#ifdef STATS_COMPACT
+	// compact whatever stats the modules wrote
+	runCompactGameStats();
+	#endif
+
 	if (patchStateContainer.UpdateGameState) {
 		patchStateContainer.UpdateGameState = 0;
 		netSendCustomAppMessage(netGetLobbyServerConnection(), NET_LOBBY_CLIENT_INDEX, CUSTOM_MSG_ID_CLIENT_SET_GAME_STATE, sizeof(UpdateGameStateRequest_t), &patchStateContainer.GameStateUpdate);
@@ -10,6 +10,8 @@
 #include <libuya/gamesettings.h>
 #include <libuya/game.h>
 #include <libuya/utils.h>
+#include <libuya/time.h>
+#include <libuya/alloc.h>
 #include <libuya/interop.h>
 #include "include/config.h"
 #include "module.h"
@@ -37,6 +39,7 @@
 #define USB_SRV_MODULE_PTR						(*(void**)0x000cfffc)
 
 #define READ_CUSTOM_MAP_EXDATA_LEN              (2048)
+#define MAP_PREFETCH_CHUNK_SIZE                 (16 * 1024)
 #define READ_CUSTOM_MAP_EXDATA_OFF              (0x150)
 #define READ_CUSTOM_MAP_FILENAME_LEN            (sizeof(MapLoaderState.MapFileName))
 
@@ -162,6 +165,7 @@ void grLoadStart();
 void hook(void);
 void loadModules(void);
 void mapResetExDataCache(void);
+void mapPrefetchWait(void);
 
 int readLevelVersion(char * name, int * version);
 
@@ -436,6 +440,8 @@ int readFileLength(char * path)
 {
 	int fd, fSize;
 
+	mapPrefetchWait();
+
 	// Open
 	rpcUSBopen(path, FIO_O_RDONLY);
 	rpcUSBSync(0, NULL, &fd);
@@ -463,6 +469,8 @@ int readFile(char * path, void * buffer, int offset, int length)
 {
 	int r, fd, fSize;
 
+	mapPrefetchWait();
+
 	// Open
 	rpcUSBopen(path, FIO_O_RDONLY);
 	rpcUSBSync(0, NULL, &fd);
@@ -580,6 +588,7 @@ int openUsb(char * filename)
 	sprintf(membuffer, filename, getMapPathPrefix(), MapLoaderState.MapFileName);
 
 	// open wad file
+	mapPrefetchWait();
 	rpcUSBopen(membuffer, FIO_O_RDONLY);
 	rpcUSBSync(0, NULL, &MapLoaderState.LoadingFd);
 	
@@ -635,6 +644,65 @@ int readUsb(u8 * buf)
 	return 1;
 }
 
+//------------------------------------------------------------------------------
+int customMapUpperBound(char* name, int len)
+{
+	int lo = 0, hi = customMapDefCount;
+
+	// first map whose name sorts after name
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (strncmp(name, customMapDefs[mid].Name, len) < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
+//------------------------------------------------------------------------------
+int customMapLowerBound(char* name, int len)
+{
+	int lo = 0, hi = customMapDefCount;
+
+	// first map whose name does not sort before name
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (strncmp(customMapDefs[mid].Name, name, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+//------------------------------------------------------------------------------
+int customMapJumpLetter(int index, int direction)
+{
+	char key[2] = {0,0};
+
+	if (customMapDefCount <= 0) return index;
+	if (index < 0 || index >= customMapDefCount) return direction > 0 ? 0 : customMapDefCount - 1;
+
+	if (direction > 0) {
+		// first map past the current letter
+		key[0] = customMapDefs[index].Name[0];
+		int next = customMapUpperBound(key, 1);
+		return next < customMapDefCount ? next : index;
+	}
+
+	// start of the current letter, or of the previous letter if already there
+	key[0] = customMapDefs[index].Name[0];
+	int start = customMapLowerBound(key, 1);
+	if (start < index || start == 0)
+		return start;
+
+	key[0] = customMapDefs[start - 1].Name[0];
+	return customMapLowerBound(key, 1);
+}
+
 void customMapInsert(char* versionFileBuffer, int versionFileBufferSize, char* filenameWithoutExtension)
 {
 	// parse extra data
@@ -651,22 +719,9 @@ void customMapInsert(char* versionFileBuffer, int versionFileBufferSize, char* f
 	}
 
 	// insert by sort, then alphabetically
-	int insertAtIdx = customMapDefCount;
-	for (i = 0; i < customMapDefCount; ++i) {
-		int c = 0; //versionFileDef.Subsort - customMapDefs[i].Subsort;
-		// if (c < 0) {
-		// 	insertAtIdx = i;
-		// 	break;
-		// }
-
-		if (c == 0) {
-			c = strncmp(versionFileDef.Name, customMapDefs[i].Name, sizeof(customMapDefs[i].Name));
-			if (c < 0) {
-				insertAtIdx = i;
-				break;
-			}
-		}
-	}
+	// binary search for the first entry that sorts after this one
+	// so maps with equal names keep the order they were found in
+	int insertAtIdx = customMapUpperBound(versionFileDef.Name, sizeof(versionFileDef.Name));
 
 	// move maps forward
 	if (insertAtIdx < customMapDefCount) {
@@ -680,8 +735,8 @@ void customMapInsert(char* versionFileBuffer, int versionFileBufferSize, char* f
 	// customMapDefs[insertAtIdx].CustomModeExtraDataMask = extraDataModeMask;
 	// customMapDefs[insertAtIdx].ShrubMinRenderDistance = versionFileDef.ShrubMinRenderDistance;
 	// customMapDefs[insertAtIdx].Subsort = versionFileDef.Subsort;
-	strcpy(customMapDefs[insertAtIdx].Filename, filenameWithoutExtension, sizeof(customMapDefs[insertAtIdx].Filename));
-	strcpy(customMapDefs[insertAtIdx].Name, versionFileDef.Name, sizeof(customMapDefs[insertAtIdx].Name));
+	strncpy(customMapDefs[insertAtIdx].Filename, filenameWithoutExtension, sizeof(customMapDefs[insertAtIdx].Filename));
+	strncpy(customMapDefs[insertAtIdx].Name, versionFileDef.Name, sizeof(customMapDefs[insertAtIdx].Name));
 	customMapDefCount++;
 }
 
@@ -701,6 +756,7 @@ int hasCustomMapsFolder(void)
 
 	// Open
 	int fd;
+	mapPrefetchWait();
 	rpcUSBdopen(dirpath);
 	rpcUSBSync(0, NULL, &fd);
 
@@ -727,6 +783,7 @@ void checkForHostFs(void)
 	snprintf(dirpath, sizeof(dirpath), "%suya", getMapPathPrefix());
 
 	// try to open directory on host:
+	mapPrefetchWait();
 	rpcUSBdopen(dirpath);
 	rpcUSBSync(0, NULL, &fd);
 
@@ -860,13 +917,8 @@ void refreshCustomMapList(void)
 
 		DPRINTF("(%d) \"%s\" f:\"%s\" v:%d bmap:%d mode:%d\n", customMapDefCount, versionFileDef.Name, filenameWithoutExtension, versionFileDef.Version, versionFileDef.BaseMapId, versionFileDef.ForcedCustomModeId);
 
-		// bring to custom map defs
-		customMapDefs[customMapDefCount].Version = versionFileDef.Version;
-		customMapDefs[customMapDefCount].BaseMapId = versionFileDef.BaseMapId;
-		customMapDefs[customMapDefCount].ForcedCustomModeId = versionFileDef.ForcedCustomModeId;
-		strncpy(customMapDefs[customMapDefCount].Filename, filenameWithoutExtension, sizeof(customMapDefs[customMapDefCount].Filename));
-		strncpy(customMapDefs[customMapDefCount].Name, versionFileDef.Name, sizeof(customMapDefs[customMapDefCount].Name));
-		customMapDefCount++;
+		// insert sorted by name
+		customMapInsert((char*)&versionFileDef, read, filenameWithoutExtension);
 
 		// reached max maps
 		if (customMapDefCount >= MAX_CUSTOM_MAP_DEFINITIONS) break;
@@ -877,18 +929,6 @@ void refreshCustomMapList(void)
 	rpcUSBdclose(fd);
 	rpcUSBSync(0, NULL, NULL);
   
-    // sort names alphabetically
-	// CustomMapDef_t temp[MAX_CUSTOM_MAP_DEFINITIONS];
-	// int k = 0, j;
-    // for(k; k < customMapDefCount; ++k) {
-    //     for(j = 0; j < customMapDefCount; ++j) {
-    //         if(strcmp(customMapDefs[k].Name, customMapDefs[j].Name) < 0) {
-    //             temp[k] = customMapDefs[k];
-    //             customMapDefs[k] = customMapDefs[j];
-    //             customMapDefs[j] = temp[k];
-    //         }
-    //     }
-    // }
 	// populate config
 	for (i = 0; i < customMapDefCount; ++i) {
 		dataCustomMaps.items[i+1] = (char*)customMapDefs[i].Name;
@@ -932,47 +972,105 @@ void soundFlushSoundCommands(void)
 }
 
 //------------------------------------------------------------------------------
-int soundLoadBankFromEE(void* buf)
+void soundLoadBankComplete(int r)
+{
+  DPRINTF("load sound bank from EE %08X to IOP %08X in %dms\n", MapLoaderState.SoundBuffer, r, (int)((timerGetSystemTime() - MapLoaderState.SoundLoadStartTime) / SYSTEM_TIME_TICKS_PER_MS));
+  MapLoaderState.SoundLoadState = SOUNDLOAD_IDLE;
+
+  if (MapLoaderState.SoundBank) {
+    freeTagged(MapLoaderState.SoundBank);
+    MapLoaderState.SoundBank = NULL;
+  }
+
+  if (MapLoaderState.SoundLoadCb) {
+    MapLoaderState.SoundLoadCb(r, MapLoaderState.SoundLoadUserData);
+    MapLoaderState.SoundLoadCb = NULL; // reset
+  }
+}
+
+//------------------------------------------------------------------------------
+void soundLoadBankPoll(void)
 {
   int r;
 
+  switch (MapLoaderState.SoundLoadState)
+  {
+    case SOUNDLOAD_WAIT_RPC:
+    {
+      // rpc client still busy
+      if (SifCheckStatRpc(LOAD_SOUND_RPC_CLIENTDATA) != 0) {
+        soundFlushSoundCommands();
+        FlushCache(0);
+        return;
+      }
+
+      // call RPC
+      *LOAD_SOUND_LOADBUSY = 1;
+      r = SifCallRpc(LOAD_SOUND_RPC_CLIENTDATA, 0x57, 1, LOAD_SOUND_LOADPARAMS, 4, LOAD_SOUND_LOADRETURNVALUE, 4, 0, 0);
+      if (r < 0) {
+        // RPC call failed
+        *LOAD_SOUND_LOCALLOADERROR = 0x106;
+        soundLoadBankComplete(0);
+        return;
+      }
+
+      MapLoaderState.SoundLoadState = SOUNDLOAD_IN_FLIGHT;
+      break;
+    }
+    case SOUNDLOAD_IN_FLIGHT:
+    {
+      // wait for load to finish
+      FlushCache(0);
+      int loadReturnValue = *LOAD_SOUND_LOADRETURNVALUE;
+      if (loadReturnValue != -1)
+        soundLoadBankComplete(loadReturnValue);
+      break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+int soundLoadBankFromEE(void* buf)
+{
   *LOAD_SOUND_LOCALLOADERROR = 0;
-  if (*LOAD_SOUND_LOADBUSY == 0) {
+  if (*LOAD_SOUND_LOADBUSY == 0 && MapLoaderState.SoundLoadState == SOUNDLOAD_IDLE) {
 
     LOAD_SOUND_LOADRETURNVALUE[0] = -1;
     LOAD_SOUND_LOADPARAMS[0] = buf;
 
     // load from
     InvalidDCache(LOAD_SOUND_LOADRETURNVALUE, LOAD_SOUND_LOADRETURNVALUE + 1);
-    while ((r = SifCheckStatRpc(LOAD_SOUND_RPC_CLIENTDATA)) != 0) {
-      soundFlushSoundCommands();
-      FlushCache(0);
-    }
-
-    // call RPC
-    *LOAD_SOUND_LOADBUSY = 1;
-    r = SifCallRpc(LOAD_SOUND_RPC_CLIENTDATA, 0x57, 1, LOAD_SOUND_LOADPARAMS, 4, LOAD_SOUND_LOADRETURNVALUE, 4, 0, 0);
-    if (r < 0) {
-      // RPC call failed
-      *LOAD_SOUND_LOCALLOADERROR = 0x106;
-      return 0;
-    } else {
-
-      // wait for load to finish
-      int loadReturnValue = *LOAD_SOUND_LOADRETURNVALUE;
-      while (loadReturnValue == -1) {
-        FlushCache(0);
-        loadReturnValue = *LOAD_SOUND_LOADRETURNVALUE;
-      }
 
-      return loadReturnValue;
-    }
+    // issue the upload now if the sound rpc client is free, otherwise soundLoadBankPoll
+    // retries it every frame. SoundLoadCb is called once the iop is done
+    MapLoaderState.SoundLoadStartTime = timerGetSystemTime();
+    MapLoaderState.SoundLoadState = SOUNDLOAD_WAIT_RPC;
+    soundLoadBankPoll();
+    return 1;
   } else {
     // busy (load already in progress), fail
     return 0;
   }
 }
 
+//------------------------------------------------------------------------------
+void * soundLoadBankCopy(void)
+{
+  // the level wad is read into the same buffer as the bank,
+  // so upload from a copy and let the level read start right away
+  if (MapLoaderState.SoundBankSize <= 0)
+    return NULL;
+
+  if (!MapLoaderState.SoundBank)
+    MapLoaderState.SoundBank = allocTagged(ALLOC_TAG_MAPLOADER, MapLoaderState.SoundBankSize);
+  if (!MapLoaderState.SoundBank)
+    return NULL;
+
+  memcpy(MapLoaderState.SoundBank, MapLoaderState.SoundBuffer, MapLoaderState.SoundBankSize);
+  FlushCache(0);
+  return MapLoaderState.SoundBank;
+}
+
 //------------------------------------------------------------------------------
 u64 hookedLevelExit(void)
 {
@@ -995,6 +1093,238 @@ u64 hookedLevelExit(void)
   return r;
 }
 
+//------------------------------------------------------------------------------
+void mapPrefetchStop(void)
+{
+  struct MapLoaderPrefetch* prefetch = &MapLoaderState.Prefetch;
+  int i;
+
+  // the read in flight has to finish before the close
+  if (prefetch->Pending) {
+    rpcUSBSync(0, NULL, NULL);
+    prefetch->Pending = 0;
+  }
+
+  // close and drop the partially read segment
+  if (prefetch->Fd >= 0) {
+    rpcUSBclose(prefetch->Fd);
+    rpcUSBSync(0, NULL, NULL);
+    prefetch->Fd = -1;
+  }
+
+  if (prefetch->Segment < PREFETCH_COUNT) {
+    for (i = prefetch->FirstBlock[prefetch->Segment]; i < prefetch->BlockCount; ++i) {
+      allocPoolPut(&prefetch->Pool, prefetch->Blocks[i]);
+      prefetch->Blocks[i] = NULL;
+    }
+
+    prefetch->Read[prefetch->Segment] = 0;
+  }
+
+  prefetch->Segment = PREFETCH_COUNT;
+}
+
+//------------------------------------------------------------------------------
+void mapPrefetchReset(void)
+{
+  struct MapLoaderPrefetch* prefetch = &MapLoaderState.Prefetch;
+
+  mapPrefetchStop();
+  allocPoolDestroy(&prefetch->Pool);
+
+  memset(prefetch, 0, sizeof(struct MapLoaderPrefetch));
+  prefetch->Fd = -1;
+}
+
+//------------------------------------------------------------------------------
+int mapPrefetchBegin(char ** files)
+{
+  struct MapLoaderPrefetch* prefetch = &MapLoaderState.Prefetch;
+  int i, blocks = 0;
+
+  for (i = 0; i < PREFETCH_COUNT; ++i) {
+    sprintf(membuffer, files[i], getMapPathPrefix(), prefetch->MapFileName);
+    int size = readFileLength(membuffer);
+    prefetch->Sizes[i] = size > 0 ? size : 0;
+    blocks += (prefetch->Sizes[i] + MAP_PREFETCH_BLOCK_SIZE - 1) / MAP_PREFETCH_BLOCK_SIZE;
+  }
+
+  // one pool for every segment, so the map is either prefetched or left to the load hooks
+  if (blocks == 0 || blocks > MAP_PREFETCH_MAX_BLOCKS)
+    return 0;
+  if (!allocPoolInit(&prefetch->Pool, ALLOC_TAG_MAPLOADER, MAP_PREFETCH_BLOCK_SIZE, blocks)) {
+    DPRINTF("prefetch: no memory for %d blocks\n", blocks);
+    return 0;
+  }
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+void mapPrefetchReadDone(int r)
+{
+  struct MapLoaderPrefetch* prefetch = &MapLoaderState.Prefetch;
+  int segment = prefetch->Segment;
+
+  prefetch->Pending = 0;
+  if (r <= 0) {
+    DPRINTF("prefetch: read failed %d\n", r);
+    mapPrefetchStop();
+    return;
+  }
+
+  prefetch->Read[segment] += r;
+  if (prefetch->Read[segment] >= prefetch->Sizes[segment]) {
+    DPRINTF("prefetch: segment %d ready (%d bytes)\n", segment, prefetch->Sizes[segment]);
+    rpcUSBclose(prefetch->Fd);
+    rpcUSBSync(0, NULL, NULL);
+    prefetch->Fd = -1;
+    prefetch->Segment++;
+  }
+}
+
+//------------------------------------------------------------------------------
+void mapPrefetchWait(void)
+{
+  int r = -1;
+
+  // the rpc client runs one command at a time, finish our read before anyone else issues one
+  if (MapLoaderState.Prefetch.Pending) {
+    rpcUSBSync(0, NULL, &r);
+    mapPrefetchReadDone(r);
+  }
+}
+
+//------------------------------------------------------------------------------
+void mapPrefetchTick(void)
+{
+  struct MapLoaderPrefetch* prefetch = &MapLoaderState.Prefetch;
+  char * files[PREFETCH_COUNT] = { fSound, fWad, fWorld };
+  int r;
+
+  // the load hooks are done with whatever they didn't use
+  if (isInGame()) {
+    if (prefetch->MapFileName[0])
+      mapPrefetchReset();
+    return;
+  }
+
+  if (!isInMenus() || rpcInit <= 0)
+    return;
+
+  // stock map selected, give the blocks back
+  if (!maploaderIsLoadingCustomMap()) {
+    if (prefetch->MapFileName[0])
+      mapPrefetchReset();
+    return;
+  }
+
+  // selection changed, size it this frame and start reading next frame
+  if (strncmp(prefetch->MapFileName, MapLoaderState.MapFileName, sizeof(prefetch->MapFileName)) != 0) {
+    mapPrefetchReset();
+    strncpy(prefetch->MapFileName, MapLoaderState.MapFileName, sizeof(prefetch->MapFileName));
+    if (!mapPrefetchBegin(files))
+      prefetch->Segment = PREFETCH_COUNT;
+    return;
+  }
+
+  // pick up the read issued on an earlier frame, once the iop is done with it
+  if (prefetch->Pending) {
+    int done = rpcUSBSyncNB(0, NULL, &r);
+    if (done == 0)
+      return;
+
+    mapPrefetchReadDone(done > 0 ? r : -1);
+    return;
+  }
+
+  int segment = prefetch->Segment;
+  if (segment >= PREFETCH_COUNT)
+    return;
+
+  if (prefetch->Sizes[segment] <= 0) {
+    prefetch->Segment++;
+    return;
+  }
+
+  // open next segment
+  if (prefetch->Fd < 0) {
+    sprintf(membuffer, files[segment], getMapPathPrefix(), prefetch->MapFileName);
+    rpcUSBopen(membuffer, FIO_O_RDONLY);
+    rpcUSBSync(0, NULL, &prefetch->Fd);
+    if (prefetch->Fd < 0) {
+      prefetch->Fd = -1;
+      mapPrefetchStop();
+      return;
+    }
+
+    prefetch->Read[segment] = 0;
+    prefetch->FirstBlock[segment] = prefetch->BlockCount;
+  }
+
+  // take a new block every MAP_PREFETCH_BLOCK_SIZE bytes
+  int offset = prefetch->Read[segment] % MAP_PREFETCH_BLOCK_SIZE;
+  if (offset == 0) {
+    void * block = allocPoolGet(&prefetch->Pool);
+    if (!block) {
+      mapPrefetchStop();
+      return;
+    }
+
+    prefetch->Blocks[prefetch->BlockCount++] = block;
+  }
+
+  // issue a chunk and let it run while the menu keeps drawing
+  int len = prefetch->Sizes[segment] - prefetch->Read[segment];
+  if (len > MAP_PREFETCH_CHUNK_SIZE)
+    len = MAP_PREFETCH_CHUNK_SIZE;
+  if (len > MAP_PREFETCH_BLOCK_SIZE - offset)
+    len = MAP_PREFETCH_BLOCK_SIZE - offset;
+
+  if (rpcUSBread(prefetch->Fd, (u8*)prefetch->Blocks[prefetch->BlockCount - 1] + offset, len) != 0) {
+    mapPrefetchStop();
+    return;
+  }
+
+  prefetch->Pending = 1;
+}
+
+//------------------------------------------------------------------------------
+int mapPrefetchServe(int segment, void * dest)
+{
+  struct MapLoaderPrefetch* prefetch = &MapLoaderState.Prefetch;
+  int size;
+  int i;
+
+  // the last chunk may still be in flight
+  mapPrefetchWait();
+
+  size = prefetch->Sizes[segment];
+  if (size <= 0 || prefetch->Read[segment] != size)
+    return 0;
+  if (strncmp(prefetch->MapFileName, MapLoaderState.MapFileName, sizeof(prefetch->MapFileName)) != 0)
+    return 0;
+
+  DPRINTF("prefetch: serving segment %d (%d bytes)\n", segment, size);
+  for (i = 0; i * MAP_PREFETCH_BLOCK_SIZE < size; ++i) {
+    int offset = i * MAP_PREFETCH_BLOCK_SIZE;
+    void ** block = &prefetch->Blocks[prefetch->FirstBlock[segment] + i];
+    int len = size - offset;
+    if (len > MAP_PREFETCH_BLOCK_SIZE)
+      len = MAP_PREFETCH_BLOCK_SIZE;
+
+    // blocks go back to the pool for the segments still being read
+    memcpy((u8*)dest + offset, *block, len);
+    allocPoolPut(&prefetch->Pool, *block);
+    *block = NULL;
+  }
+
+  MapLoaderState.LoadingFileSize = size;
+  prefetch->Read[segment] = 0;
+  prefetch->Served = 1;
+  return 1;
+}
+
 //------------------------------------------------------------------------------
 int beginLoadingLevelWad(int loadGameplay)
 {
@@ -1017,6 +1347,12 @@ int beginLoadingLevelWad(int loadGameplay)
     }
   }
 
+  // already in memory
+  if (filename != NULL && mapPrefetchServe(loadGameplay ? PREFETCH_GAMEPLAY : PREFETCH_LEVEL, dest)) {
+    MapLoaderState.Loaded |= loadGameplay ? MAPLOADED_GAMEPLAY : MAPLOADED_LEVEL;
+    return 1;
+  }
+
   if (filename != NULL)
   {
     DPRINTF("loading %s\n", filename);
@@ -1036,9 +1372,18 @@ int beginLoadingLevelWad(int loadGameplay)
 //------------------------------------------------------------------------------
 int beginLoadingSoundWad(void* dest)
 {
+  // already in memory
+  if (mapPrefetchServe(PREFETCH_SOUND, dest)) {
+    MapLoaderState.SoundBuffer = dest;
+    MapLoaderState.SoundBankSize = MapLoaderState.LoadingFileSize;
+    MapLoaderState.Loaded |= MAPLOADED_SOUND;
+    return 1;
+  }
+
   int fSize = openUsb(fSound);
   if (fSize > 0) {
     MapLoaderState.SoundBuffer = dest;
+    MapLoaderState.SoundBankSize = fSize;
 
     DPRINTF("level: %08X\nsound: %08X\n", MapLoaderState.LevelBuffer, MapLoaderState.SoundBuffer);
 
@@ -1061,7 +1406,11 @@ void hookedLoad(void * dest, u32 sectorStart, u32 sectorSize)
     MapLoaderState.LevelBuffer = dest;
     MapLoaderState.GameplayBuffer = 0;
     MapLoaderState.SoundBuffer = 0;
+    MapLoaderState.SoundBankSize = 0;
     MapLoaderState.Loaded = 0;
+
+    // keep finished segments, drop whatever was still streaming
+    mapPrefetchStop();
   } else {
     MapLoaderState.GameplayBuffer = dest;
   }
@@ -1086,11 +1435,43 @@ void hookedLoad(void * dest, u32 sectorStart, u32 sectorSize)
 	((void (*)(void*, u32, u32))LEVEL_CDVD_LOAD_ASYNC_FUNC)(dest, sectorStart, sectorSize);
 }
 
+//------------------------------------------------------------------------------
+u32 mapSegmentLoaded(int a0)
+{
+  if ((MapLoaderState.Loaded & MAPLOADED_SOUND_SENT) == 0 && (MapLoaderState.Loaded & MAPLOADED_SOUND)) {
+    // finish loading sound wad
+    ((void (*)())LOAD_LEVEL_SOUND_INIT_FUNC)();       // sound_LevelInit()
+    ((void (*)())LOAD_LEVEL_SOUND_LOAD_BANK_FUNC)();  // music_LoadCoreBank()
+    POKE_U32(LOAD_LEVEL_SOUND_NOP_ADDR, 0);           // nop sound_LevelInit()
+    POKE_U32(LOAD_LEVEL_SOUND_NOP_ADDR + 8, 0);       // nop music_LoadCoreBank()
+  }
+
+  if ((MapLoaderState.Loaded & MAPLOADED_LEVEL) == 0 && MapLoaderState.LevelBuffer) {
+    // load level wad
+    if (beginLoadingLevelWad(0)) return 1;
+  } else if ((MapLoaderState.Loaded & MAPLOADED_GAMEPLAY) == 0 && MapLoaderState.GameplayBuffer) {
+    // load gameplay wad
+    if (beginLoadingLevelWad(1)) return 1;
+  }
+
+  // finished loading level +/ sound wads
+  return cdvdSync(a0);
+}
+
 //------------------------------------------------------------------------------
 u32 hookedCheck(int a0)
 {
 	int r, cmd;
 
+	// advance the sound bank upload alongside the wad reads
+	soundLoadBankPoll();
+
+	// served from the staging prefetch, there's no usb read to wait on
+	if (MapLoaderState.Prefetch.Served && MapLoaderState.Enabled) {
+		MapLoaderState.Prefetch.Served = 0;
+		return mapSegmentLoaded(a0);
+	}
+
 	// If the wad is not open then we're loading from cdvd
 	if (MapLoaderState.LoadingFd < 0 || !MapLoaderState.Enabled)
 		return cdvdSync(a0);
@@ -1112,24 +1493,7 @@ u32 hookedCheck(int a0)
 			rpcUSBSync(0, NULL, NULL);
 			MapLoaderState.LoadingFd = -1;
 
-      if ((MapLoaderState.Loaded & MAPLOADED_SOUND_SENT) == 0 && (MapLoaderState.Loaded & MAPLOADED_SOUND)) {
-        // finish loading sound wad
-        ((void (*)())LOAD_LEVEL_SOUND_INIT_FUNC)();       // sound_LevelInit()
-        ((void (*)())LOAD_LEVEL_SOUND_LOAD_BANK_FUNC)();  // music_LoadCoreBank()
-        POKE_U32(LOAD_LEVEL_SOUND_NOP_ADDR, 0);           // nop sound_LevelInit()
-        POKE_U32(LOAD_LEVEL_SOUND_NOP_ADDR + 8, 0);       // nop music_LoadCoreBank()
-      }
-
-      if ((MapLoaderState.Loaded & MAPLOADED_LEVEL) == 0 && MapLoaderState.LevelBuffer) {
-        // load level wad
-        if (beginLoadingLevelWad(0)) return;
-      } else if ((MapLoaderState.Loaded & MAPLOADED_GAMEPLAY) == 0 && MapLoaderState.GameplayBuffer) {
-        // load gameplay wad
-        if (beginLoadingLevelWad(1)) return;
-      }
-
-      // finished loading level +/ sound wads
-			return cdvdSync(a0);
+			return mapSegmentLoaded(a0);
 		}
 	}
 
@@ -1220,14 +1584,21 @@ void hookedSoundCoreBankLoad(int loc, int offset, SndCompleteProc cb, u64 user_d
     *(u64*)0x00240d58 = user_data;
     *(u32*)0x00240D50 = cb;
   
-    // sound wad finished, pass to Cb
+    // sound wad finished, upload to the iop in the background
+    // SoundLoadCb is called from soundLoadBankPoll when it's done
     if (cb && (MapLoaderState.Loaded & MAPLOADED_SOUND_SENT) == 0 && (MapLoaderState.Loaded & MAPLOADED_SOUND)) {
-
-      int r = soundLoadBankFromEE(MapLoaderState.SoundBuffer);
-      DPRINTF("load sound bank from EE %08X to IOP %08X\n", MapLoaderState.SoundBuffer, r);
-      if (MapLoaderState.SoundLoadCb) {
-        MapLoaderState.SoundLoadCb(r, MapLoaderState.SoundLoadUserData);
+      void * bank = soundLoadBankCopy();
+      if (!soundLoadBankFromEE(bank ? bank : MapLoaderState.SoundBuffer)) {
+        if (bank) {
+          freeTagged(bank);
+          MapLoaderState.SoundBank = NULL;
+        }
+        MapLoaderState.SoundLoadCb(0, MapLoaderState.SoundLoadUserData);
         MapLoaderState.SoundLoadCb = NULL; // reset
+      } else if (!bank) {
+        // no memory for a copy, finish the upload before the level wad overwrites it
+        while (MapLoaderState.SoundLoadState != SOUNDLOAD_IDLE)
+          soundLoadBankPoll();
       }
       MapLoaderState.Loaded |= MAPLOADED_SOUND_SENT;
     }
@@ -1358,14 +1729,14 @@ int align(int addr, int align)
 int mapsAllocateModuleBuffer(void)
 {
 	if (!USB_FS_MODULE_PTR) {
-		USB_FS_MODULE_PTR = malloc(41216);
+		USB_FS_MODULE_PTR = allocTagged(ALLOC_TAG_MAPLOADER, 41216);
 		if (USB_FS_MODULE_PTR) {
 			memset(USB_FS_MODULE_PTR, 0, 41216);
 			USB_FS_MODULE_PTR = (void*)align((int)USB_FS_MODULE_PTR, 0x10);
 		}
 	}
 	if (!USB_SRV_MODULE_PTR) {
-		USB_SRV_MODULE_PTR = malloc(12288);
+		USB_SRV_MODULE_PTR = allocTagged(ALLOC_TAG_MAPLOADER, 12288);
 		if (USB_SRV_MODULE_PTR) {
 			memset(USB_SRV_MODULE_PTR, 0, 12288);
 			USB_SRV_MODULE_PTR = (void*)align((int)USB_SRV_MODULE_PTR, 0x10);
@@ -1498,14 +1869,16 @@ void runMapLoader(void)
 	// hook irx module loading 
 	hook();
 
+	soundLoadBankPoll();
+
 	// if (isUnloading) {
 	// 	if (customMapDefs) {
-	// 		free(customMapDefs);
+	// 		freeTagged(customMapDefs);
 	// 		customMapDefs = NULL;
 	// 	}
 
 	// 	if (customMapExDataBuf) {
-	// 		free(customMapExDataBuf);
+	// 		freeTagged(customMapExDataBuf);
 	// 		customMapExDataBuf = NULL;
 	// 	}
 	// }
@@ -1517,15 +1890,16 @@ void runMapLoader(void)
 		// set map loader defaults
 		MapLoaderState.Enabled = 0;
 		MapLoaderState.CheckState = 0;
-
+		MapLoaderState.Prefetch.Fd = -1;
+		MapLoaderState.Prefetch.Segment = PREFETCH_COUNT;
 
 		if (!customMapExDataBuf) {
-			customMapExDataBuf = malloc(READ_CUSTOM_MAP_EXDATA_LEN);
+			customMapExDataBuf = allocTagged(ALLOC_TAG_MAPLOADER, READ_CUSTOM_MAP_EXDATA_LEN);
 			memset(customMapExDataBuf, 0, READ_CUSTOM_MAP_EXDATA_LEN);
 		}
 
 		if (!customMapDefs) {
-			customMapDefs = malloc(sizeof(CustomMapDef_t) * MAX_CUSTOM_MAP_DEFINITIONS);
+			customMapDefs = allocTagged(ALLOC_TAG_MAPLOADER, sizeof(CustomMapDef_t) * MAX_CUSTOM_MAP_DEFINITIONS);
 			DPRINTF("CUSTOMMAPDEFS MALLOC: %08x", customMapDefs);
 		}
 
@@ -1550,6 +1924,9 @@ void runMapLoader(void)
 	}
 	wasInGame = isInGame();
 
+	// read the selected map into memory while in staging
+	mapPrefetchTick();
+
 	// if maps are refreshing, show popup.
 	if (actionState == ACTION_REFRESHING_MAPLIST) {
 		u32 bgColorDownload = 0x8004223f;
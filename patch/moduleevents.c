@@ -0,0 +1,282 @@
+/***************************************************
+ * FILENAME :		moduleevents.c
+ * DESCRIPTION :
+ * 		Publishes game events to the game modules that subscribed
+ *    to them (see ModuleEvent in module.h), so modules don't have
+ *    to poll game state every frame to notice them.
+ *    Also times every module entrypoint and event handler.
+ */
+
+#include <tamtypes.h>
+#include <string.h>
+
+#include <libuya/stdio.h>
+#include <libuya/string.h>
+#include <libuya/game.h>
+#include <libuya/player.h>
+#include <libuya/time.h>
+#include "module.h"
+#include "include/config.h"
+
+#define GLOBAL_GAME_MODULES_START               ((GameModule*)0x000cf000)
+#define MODULE_EVENT_MAX_SUBSCRIBERS            (16)
+#define MODULE_EVENT_MAX_TIMED_MODULES          (16)
+#define MODULE_EVENT_PLAYER_MASK                (MODULE_EVENT_MASK(MODULE_EVENT_PLAYER_SPAWN) | MODULE_EVENT_MASK(MODULE_EVENT_PLAYER_DEATH) | MODULE_EVENT_MASK(MODULE_EVENT_PLAYER_TEAM_CHANGE))
+
+typedef struct ModuleEventSubscriber
+{
+  GameModule * Module;
+  u32 Mask;
+  ModuleEventHandler_f Handler;
+} ModuleEventSubscriber_t;
+
+typedef struct ModuleTiming
+{
+  int TotalUs;
+  int MaxUs;
+  int Calls;
+} ModuleTiming_t;
+
+struct ModuleEventState
+{
+  int LastFrame;
+  int Scene;
+  int GameEnded;
+  int SubscriberCount;
+  int Publishing;
+  int RemovePending;
+  u32 SubscribedMask;
+  char PlayerValid[GAME_MAX_PLAYERS];
+  char PlayerDead[GAME_MAX_PLAYERS];
+  char PlayerTeam[GAME_MAX_PLAYERS];
+  ModuleEventSubscriber_t Subscribers[MODULE_EVENT_MAX_SUBSCRIBERS];
+  ModuleTiming_t Timings[MODULE_EVENT_MAX_TIMED_MODULES];
+} ModuleEventState = { .LastFrame = -1, .Scene = -1 };
+
+extern PatchConfig_t config;
+extern PatchGameConfig_t gameConfig;
+
+//--------------------------------------------------------------------------
+void moduleEventRecordTime(GameModule * module, long ticks)
+{
+  int index = module - GLOBAL_GAME_MODULES_START;
+  if (index < 0 || index >= MODULE_EVENT_MAX_TIMED_MODULES)
+    return;
+
+  // convert per sample so the totals don't overflow over a match
+  int us = (int)(ticks / (SYSTEM_TIME_TICKS_PER_MS / 1000));
+  ModuleTiming_t* timing = &ModuleEventState.Timings[index];
+  timing->TotalUs += us;
+  timing->Calls += 1;
+  if (us > timing->MaxUs)
+    timing->MaxUs = us;
+}
+
+//--------------------------------------------------------------------------
+void moduleEventInvoke(GameModule * module, ModuleStart entrypoint)
+{
+  long start = timerGetSystemTime();
+  entrypoint(module, &config, &gameConfig);
+  moduleEventRecordTime(module, timerGetSystemTime() - start);
+}
+
+//--------------------------------------------------------------------------
+void moduleEventUpdateMask(void)
+{
+  int i;
+
+  ModuleEventState.SubscribedMask = 0;
+  for (i = 0; i < ModuleEventState.SubscriberCount; ++i)
+    ModuleEventState.SubscribedMask |= ModuleEventState.Subscribers[i].Mask;
+}
+
+//--------------------------------------------------------------------------
+void moduleEventRemoveUnsubscribed(void)
+{
+  int i = 0;
+
+  ModuleEventState.RemovePending = 0;
+  while (i < ModuleEventState.SubscriberCount) {
+    if (!ModuleEventState.Subscribers[i].Mask) {
+      ModuleEventState.Subscribers[i] = ModuleEventState.Subscribers[--ModuleEventState.SubscriberCount];
+      continue;
+    }
+
+    ++i;
+  }
+}
+
+//--------------------------------------------------------------------------
+int moduleEventSubscribe(GameModule * module, u32 eventMask, ModuleEventHandler_f handler)
+{
+  int i;
+  if (!module || !handler)
+    return 0;
+
+  for (i = 0; i < ModuleEventState.SubscriberCount; ++i) {
+    ModuleEventSubscriber_t* sub = &ModuleEventState.Subscribers[i];
+    if (sub->Module != module || sub->Handler != handler)
+      continue;
+
+    // resubscribe with a new mask, or unsubscribe with 0
+    // removing mid publish would move a subscriber the loop hasn't reached yet
+    if (eventMask) {
+      sub->Mask = eventMask;
+    } else if (ModuleEventState.Publishing) {
+      sub->Mask = 0;
+      ModuleEventState.RemovePending = 1;
+    } else {
+      ModuleEventState.Subscribers[i] = ModuleEventState.Subscribers[--ModuleEventState.SubscriberCount];
+    }
+
+    moduleEventUpdateMask();
+    return 1;
+  }
+
+  if (!eventMask)
+    return 1;
+  if (ModuleEventState.SubscriberCount >= MODULE_EVENT_MAX_SUBSCRIBERS) {
+    DPRINTF("module events: no room for %08X\n", (u32)module);
+    return 0;
+  }
+
+  ModuleEventSubscriber_t* sub = &ModuleEventState.Subscribers[ModuleEventState.SubscriberCount++];
+  sub->Module = module;
+  sub->Mask = eventMask;
+  sub->Handler = handler;
+  moduleEventUpdateMask();
+  return 1;
+}
+
+//--------------------------------------------------------------------------
+void moduleEventPublish(int event, void * arg)
+{
+  int i;
+  u32 bit = MODULE_EVENT_MASK(event);
+  if ((ModuleEventState.SubscribedMask & bit) == 0)
+    return;
+
+  // handlers subscribed during this publish wait for the next event
+  int count = ModuleEventState.SubscriberCount;
+  ++ModuleEventState.Publishing;
+  for (i = 0; i < count; ++i) {
+    ModuleEventSubscriber_t* sub = &ModuleEventState.Subscribers[i];
+    if ((sub->Mask & bit) == 0 || sub->Module->State == GAMEMODULE_OFF)
+      continue;
+
+    long start = timerGetSystemTime();
+    sub->Handler(sub->Module, event, arg);
+    moduleEventRecordTime(sub->Module, timerGetSystemTime() - start);
+  }
+
+  if (--ModuleEventState.Publishing == 0 && ModuleEventState.RemovePending)
+    moduleEventRemoveUnsubscribed();
+}
+
+//--------------------------------------------------------------------------
+void moduleEventPruneSubscribers(void)
+{
+  int i = 0;
+  int count = ModuleEventState.SubscriberCount;
+
+  // modules that were turned off or unloaded must subscribe again
+  while (i < ModuleEventState.SubscriberCount) {
+    GameModule* module = ModuleEventState.Subscribers[i].Module;
+    if (module->State == GAMEMODULE_OFF || (!module->GameEntrypoint && !module->LobbyEntrypoint)) {
+      ModuleEventState.Subscribers[i] = ModuleEventState.Subscribers[--ModuleEventState.SubscriberCount];
+      continue;
+    }
+
+    ++i;
+  }
+
+  if (count != ModuleEventState.SubscriberCount)
+    moduleEventUpdateMask();
+}
+
+//--------------------------------------------------------------------------
+void moduleEventTickPlayers(void)
+{
+  int i;
+  Player** players = playerGetAll();
+
+  for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
+    Player* player = players[i];
+    if (!player) {
+      ModuleEventState.PlayerValid[i] = 0;
+      continue;
+    }
+
+    char dead = playerIsDead(player) ? 1 : 0;
+    char team = (char)player->mpTeam;
+
+    // first sighting only takes a snapshot
+    if (ModuleEventState.PlayerValid[i]) {
+      if (dead && !ModuleEventState.PlayerDead[i])
+        moduleEventPublish(MODULE_EVENT_PLAYER_DEATH, player);
+      else if (!dead && ModuleEventState.PlayerDead[i])
+        moduleEventPublish(MODULE_EVENT_PLAYER_SPAWN, player);
+
+      if (team != ModuleEventState.PlayerTeam[i])
+        moduleEventPublish(MODULE_EVENT_PLAYER_TEAM_CHANGE, player);
+    }
+
+    ModuleEventState.PlayerValid[i] = 1;
+    ModuleEventState.PlayerDead[i] = dead;
+    ModuleEventState.PlayerTeam[i] = team;
+  }
+}
+
+//--------------------------------------------------------------------------
+void moduleEventTick(void)
+{
+  // modules may be processed more than once a frame
+  int frame = gameGetGSFrame();
+  if (frame == ModuleEventState.LastFrame)
+    return;
+  ModuleEventState.LastFrame = frame;
+
+  moduleEventPruneSubscribers();
+
+  int scene = isInGame() ? MODULE_SCENE_GAME : (isInMenus() ? MODULE_SCENE_MENUS : MODULE_SCENE_LOADING);
+  if (scene != ModuleEventState.Scene) {
+    ModuleEventState.Scene = scene;
+    moduleEventPublish(MODULE_EVENT_SCENE_CHANGE, (void*)scene);
+
+    if (scene == MODULE_SCENE_GAME) {
+      ModuleEventState.GameEnded = 0;
+      memset(ModuleEventState.PlayerValid, 0, sizeof(ModuleEventState.PlayerValid));
+      moduleEventPublish(MODULE_EVENT_GAME_START, NULL);
+    }
+  }
+
+  if (scene != MODULE_SCENE_GAME)
+    return;
+
+  if (!ModuleEventState.GameEnded && gameHasEnded()) {
+    ModuleEventState.GameEnded = 1;
+    moduleEventPublish(MODULE_EVENT_GAME_END, NULL);
+  }
+
+  // only walk the players if someone is listening
+  if (ModuleEventState.SubscribedMask & MODULE_EVENT_PLAYER_MASK)
+    moduleEventTickPlayers();
+}
+
+#ifdef DEBUG
+//--------------------------------------------------------------------------
+void moduleEventPrintTimings(void)
+{
+  int i;
+
+  for (i = 0; i < MODULE_EVENT_MAX_TIMED_MODULES; ++i) {
+    ModuleTiming_t* timing = &ModuleEventState.Timings[i];
+    if (!timing->Calls)
+      continue;
+
+    printf("module %d: %d calls, avg %dus, max %dus\n", i, timing->Calls, timing->TotalUs / timing->Calls, timing->MaxUs);
+  }
+
+  memset(ModuleEventState.Timings, 0, sizeof(ModuleEventState.Timings));
+}
+#endif
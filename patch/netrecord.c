@@ -0,0 +1,239 @@
+/***************************************************
+ * FILENAME :		netrecord.c
+ * DESCRIPTION :
+ * 		Records every custom message sent or handled during a match
+ *    into a ring buffer and writes it to USB/host at match end.
+ *
+ *    Only built with -DNET_RECORD.
+ *
+ *    File format (little endian):
+ *      NetRecordHeader_t
+ *      RecordCount x {
+ *        NetRecordEntry_t
+ *        Size bytes of payload, padded to 4
+ *      }
+ *
+ *    Records are in the order they happened. When the ring fills
+ *    the oldest records are dropped and counted in Dropped.
+ *    misc/netdump.c decodes captures on the host.
+ */
+
+#include <tamtypes.h>
+#include <string.h>
+
+#include <libuya/stdio.h>
+#include <libuya/stdlib.h>
+#include <libuya/alloc.h>
+#include <libuya/string.h>
+#include <libuya/net.h>
+#include <libuya/game.h>
+#include <libuya/time.h>
+#include "rpc.h"
+
+#define NET_RECORD_MAGIC              (0x4345524E) // NREC
+#define NET_RECORD_VERSION            (1)
+#define NET_RECORD_BUFFER_SIZE        (64 * 1024)
+#define NET_RECORD_MAX_PAYLOAD        (512)
+
+typedef struct NetRecordHeader
+{
+  u32 Magic;
+  u16 Version;
+  u16 EntrySize;
+  int ClientId;
+  int StartTime;
+  int RecordCount;
+  int Dropped;
+} NetRecordHeader_t;
+
+typedef struct NetRecordEntry
+{
+  int Time;
+  u8 Direction;
+  u8 MsgId;
+  short ClientIndex;
+  u16 Size;
+  u16 Pad;
+} NetRecordEntry_t;
+
+struct NetRecordState
+{
+  u8* Buffer;
+  int Head;
+  int Tail;
+  int Used;
+  int Active;
+  NetRecordHeader_t Header;
+} NetRecordState = {0};
+
+extern int rpcInit;
+char * getMapPathPrefix(void);
+void mapPrefetchWait(void);
+
+//--------------------------------------------------------------------------
+void netRecordRingWrite(void* src, int size)
+{
+  int first = NET_RECORD_BUFFER_SIZE - NetRecordState.Head;
+  if (first > size)
+    first = size;
+
+  memcpy(NetRecordState.Buffer + NetRecordState.Head, src, first);
+  if (size > first)
+    memcpy(NetRecordState.Buffer, (u8*)src + first, size - first);
+
+  NetRecordState.Head = (NetRecordState.Head + size) % NET_RECORD_BUFFER_SIZE;
+  NetRecordState.Used += size;
+}
+
+//--------------------------------------------------------------------------
+void netRecordRingPeek(void* dst, int size)
+{
+  int first = NET_RECORD_BUFFER_SIZE - NetRecordState.Tail;
+  if (first > size)
+    first = size;
+
+  memcpy(dst, NetRecordState.Buffer + NetRecordState.Tail, first);
+  if (size > first)
+    memcpy((u8*)dst + first, NetRecordState.Buffer, size - first);
+}
+
+//--------------------------------------------------------------------------
+void netRecordOnMessage(int direction, int clientIndex, u8 customMsgId, int msgSize, void * payload)
+{
+  NetRecordEntry_t entry;
+  if (!NetRecordState.Active) return;
+
+  if (!payload || msgSize < 0)
+    msgSize = 0;
+  if (msgSize > NET_RECORD_MAX_PAYLOAD)
+    msgSize = NET_RECORD_MAX_PAYLOAD;
+
+  int paddedSize = (msgSize + 3) & ~3;
+  int recordSize = sizeof(NetRecordEntry_t) + paddedSize;
+
+  // drop oldest until it fits
+  while ((NET_RECORD_BUFFER_SIZE - NetRecordState.Used) < recordSize) {
+    NetRecordEntry_t oldest;
+    netRecordRingPeek(&oldest, sizeof(oldest));
+    int oldestSize = sizeof(NetRecordEntry_t) + ((oldest.Size + 3) & ~3);
+    NetRecordState.Tail = (NetRecordState.Tail + oldestSize) % NET_RECORD_BUFFER_SIZE;
+    NetRecordState.Used -= oldestSize;
+    NetRecordState.Header.RecordCount -= 1;
+    NetRecordState.Header.Dropped += 1;
+  }
+
+  entry.Time = gameGetTime();
+  entry.Direction = (u8)direction;
+  entry.MsgId = customMsgId;
+  entry.ClientIndex = (short)clientIndex;
+  entry.Size = (u16)msgSize;
+  entry.Pad = 0;
+  netRecordRingWrite(&entry, sizeof(entry));
+
+  // payload followed by zero padding
+  if (msgSize > 0)
+    netRecordRingWrite(payload, msgSize);
+  if (paddedSize > msgSize) {
+    u32 zero = 0;
+    netRecordRingWrite(&zero, paddedSize - msgSize);
+  }
+
+  NetRecordState.Header.RecordCount += 1;
+}
+
+//--------------------------------------------------------------------------
+void netRecordBegin(void)
+{
+  NetRecordState.Buffer = allocTagged(ALLOC_TAG_NET, NET_RECORD_BUFFER_SIZE);
+  if (!NetRecordState.Buffer) {
+    DPRINTF("netrecord: unable to allocate %d bytes\n", NET_RECORD_BUFFER_SIZE);
+    return;
+  }
+
+  NetRecordState.Head = 0;
+  NetRecordState.Tail = 0;
+  NetRecordState.Used = 0;
+  memset(&NetRecordState.Header, 0, sizeof(NetRecordState.Header));
+  NetRecordState.Header.Magic = NET_RECORD_MAGIC;
+  NetRecordState.Header.Version = NET_RECORD_VERSION;
+  NetRecordState.Header.EntrySize = sizeof(NetRecordEntry_t);
+  NetRecordState.Header.ClientId = gameGetMyClientId();
+  NetRecordState.Header.StartTime = gameGetTime();
+  NetRecordState.Active = 1;
+
+  netSetRecordCallback(&netRecordOnMessage);
+}
+
+//--------------------------------------------------------------------------
+int netRecordWrite(int fd, void* buf, int size)
+{
+  int r = 0;
+  if (size <= 0) return 0;
+
+  rpcUSBwrite(fd, buf, size);
+  rpcUSBSync(0, NULL, &r);
+  return r;
+}
+
+//--------------------------------------------------------------------------
+void netRecordEnd(void)
+{
+  char path[64];
+  int fd;
+
+  netSetRecordCallback(NULL);
+  NetRecordState.Active = 0;
+  if (!NetRecordState.Buffer) return;
+
+  // only write if the usb modules are loaded
+  if (rpcInit > 0) {
+    mapPrefetchWait();
+    sprintf(path, "%snetrec_%08X.bin", getMapPathPrefix(), (u32)(timerGetSystemTime() / SYSTEM_TIME_TICKS_PER_MS));
+
+    rpcUSBopen(path, FIO_O_WRONLY | FIO_O_CREAT | FIO_O_TRUNC);
+    rpcUSBSync(0, NULL, &fd);
+    if (fd < 0) {
+      DPRINTF("netrecord: error opening %s: %d\n", path, fd);
+    } else {
+      // header, then the ring from oldest to newest
+      int first = NET_RECORD_BUFFER_SIZE - NetRecordState.Tail;
+      if (first > NetRecordState.Used)
+        first = NetRecordState.Used;
+
+      netRecordWrite(fd, &NetRecordState.Header, sizeof(NetRecordState.Header));
+      netRecordWrite(fd, NetRecordState.Buffer + NetRecordState.Tail, first);
+      netRecordWrite(fd, NetRecordState.Buffer, NetRecordState.Used - first);
+
+      rpcUSBclose(fd);
+      rpcUSBSync(0, NULL, NULL);
+      DPRINTF("netrecord: wrote %d records (%d dropped) to %s\n", NetRecordState.Header.RecordCount, NetRecordState.Header.Dropped, path);
+    }
+  }
+
+  freeTagged(NetRecordState.Buffer);
+  NetRecordState.Buffer = NULL;
+}
+
+//--------------------------------------------------------------------------
+void netRecordTick(void)
+{
+  static int recorded = 0;
+
+  if (!isInGame()) {
+    if (NetRecordState.Active)
+      netRecordEnd();
+
+    recorded = 0;
+    return;
+  }
+
+  // start once per match
+  if (!recorded) {
+    recorded = 1;
+    netRecordBegin();
+  }
+
+  // write as soon as the match ends
+  if (NetRecordState.Active && gameHasEnded())
+    netRecordEnd();
+}
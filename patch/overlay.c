@@ -0,0 +1,118 @@
+/***************************************************
+ * FILENAME :		overlay.c
+ * DESCRIPTION :
+ * 		Loads subsystems that are only needed in some scenes
+ *    (see patch/overlays) from USB into the shared overlay
+ *    window (OVERLAY_WINDOW in regions.ld) and evicts them when
+ *    the scene ends.
+ *
+ *    Only built with -DUI_OVERLAY.
+ */
+
+#include <tamtypes.h>
+#include <string.h>
+
+#include <libuya/stdio.h>
+#include <libuya/string.h>
+#include <libuya/utils.h>
+#include "overlay.h"
+
+#define LOAD_MODULES_STATE                      (*(u8*)0x000cfff0)
+#define HAS_LOADED_MODULES                      (LOAD_MODULES_STATE == 100)
+
+extern char OVERLAY_WINDOW[];
+extern char OVERLAY_WINDOW_SIZE[];
+extern char SECTION_PATCH_END[];
+
+int readFileLength(char * path);
+int readFile(char * path, void * buffer, int offset, int length);
+char * getMapPathPrefix(void);
+extern void FlushCache(int);
+
+int overlayLoadedId = OVERLAY_NONE;
+int overlayLastFailedId = OVERLAY_NONE;
+
+//--------------------------------------------------------------------------
+char * overlayGetFilename(int id)
+{
+  switch (id)
+  {
+    case OVERLAY_UI: return OVERLAY_UI_FILENAME;
+    default: return NULL;
+  }
+}
+
+//--------------------------------------------------------------------------
+int overlayGetLoadedId(void)
+{
+  return overlayLoadedId;
+}
+
+//--------------------------------------------------------------------------
+void * overlayGetExport(int index)
+{
+  OverlayHeader_t* header = (OverlayHeader_t*)OVERLAY_WINDOW;
+  if (overlayLoadedId == OVERLAY_NONE || index < 0 || index >= OVERLAY_MAX_EXPORTS)
+    return NULL;
+
+  return header->Exports[index];
+}
+
+//--------------------------------------------------------------------------
+void overlayUnload(void)
+{
+  // allow a failed overlay to be retried next scene
+  overlayLastFailedId = OVERLAY_NONE;
+  if (overlayLoadedId == OVERLAY_NONE)
+    return;
+
+  DPRINTF("overlay: evicting %d\n", overlayLoadedId);
+  memset(OVERLAY_WINDOW, 0, sizeof(OverlayHeader_t));
+  overlayLoadedId = OVERLAY_NONE;
+}
+
+//--------------------------------------------------------------------------
+int overlayLoad(int id)
+{
+  char path[128];
+  OverlayHeader_t* header = (OverlayHeader_t*)OVERLAY_WINDOW;
+  char * filename = overlayGetFilename(id);
+
+  if (overlayLoadedId == id)
+    return 1;
+
+  // don't retry a missing overlay every frame
+  if (!filename || !HAS_LOADED_MODULES || overlayLastFailedId == id)
+    return 0;
+
+  overlayUnload();
+  overlayLastFailedId = id;
+
+  snprintf(path, sizeof(path), "%suya/%s", getMapPathPrefix(), filename);
+  int size = readFileLength(path);
+  if (size < (int)sizeof(OverlayHeader_t) || size > (int)OVERLAY_WINDOW_SIZE) {
+    DPRINTF("overlay: %s has bad size %d (window %d)\n", path, size, (int)OVERLAY_WINDOW_SIZE);
+    return 0;
+  }
+
+  if (readFile(path, OVERLAY_WINDOW, 0, size) != size) {
+    DPRINTF("overlay: error reading %s\n", path);
+    memset(OVERLAY_WINDOW, 0, sizeof(OverlayHeader_t));
+    return 0;
+  }
+
+  // must be built against this exact patch
+  if (header->Magic != OVERLAY_MAGIC || header->Id != id || header->Size > size || header->PatchEnd != (u32)SECTION_PATCH_END) {
+    DPRINTF("overlay: %s does not match this patch\n", path);
+    memset(OVERLAY_WINDOW, 0, sizeof(OverlayHeader_t));
+    return 0;
+  }
+
+  // ensure execution does not use stale cached code
+  FlushCache(0);
+  FlushCache(2);
+  overlayLoadedId = id;
+  overlayLastFailedId = OVERLAY_NONE;
+  DPRINTF("overlay: loaded %s (%d bytes)\n", path, size);
+  return 1;
+}
@@ -0,0 +1,5 @@
+# Overlays have no entry point, the patch calls into them
+# through the exports in OverlayHeader_t (see header.c).
+
+.set noat
+.set noreorder
@@ -0,0 +1,27 @@
+/***************************************************
+ * FILENAME :		header.c
+ * DESCRIPTION :
+ * 		Header of the staging/keyboard ui overlay.
+ *    Linked first so it sits at the start of the window,
+ *    see patch/overlay.c for how it is checked and used.
+ */
+
+#include <tamtypes.h>
+#include "overlay.h"
+
+int patchStaging(void * ui, long pad);
+int patchKeyboard(void * ui, int pad);
+
+extern char _OVERLAY_SIZE[];
+extern char SECTION_PATCH_END[];
+
+OverlayHeader_t overlayHeader __attribute__((section(".overlay_header"))) = {
+  .Magic = OVERLAY_MAGIC,
+  .Id = OVERLAY_UI,
+  .Size = (u32)_OVERLAY_SIZE,
+  .PatchEnd = (u32)SECTION_PATCH_END,
+  .Exports = {
+    [OVERLAY_UI_EXPORT_STAGING] (void*)&patchStaging,
+    [OVERLAY_UI_EXPORT_KEYBOARD] (void*)&patchKeyboard,
+  }
+};
@@ -9,7 +9,10 @@
 #include <libuya/stdio.h>
 #include <libuya/game.h>
 #include <libuya/stdlib.h>
+#include <libuya/alloc.h>
 #include <libuya/utils.h>
+#include <libuya/time.h>
+#include <libuya/collision.h>
 #include "messageid.h"
 #include "config.h"
 #include <libuya/net.h>
@@ -17,6 +20,12 @@
 
 #define PLAYER_SYNC_DATAS_PTR     (*(PlayerSyncPlayerData_t**)0x000CFFB0)
 #define CMD_BUFFER_SIZE           (8)
+#define EXTRAPOLATE_MAX_MS        (200)   // how far past the last received state we'll dead-reckon
+#define VELOCITY_MAX_DT_MS        (500)   // ignore velocity estimates across larger packet gaps
+#define PEER_MAX_INTERVAL         (CMD_BUFFER_SIZE / 2) // most send ticks a peer can go without an update
+#define PEER_NEAR_DIST            (15)
+#define PEER_FAR_DIST             (60)
+#define PEER_COMBAT_TICKS         (2 * 60)
 
 // TODO players don't exit from vehicles for remote players, vehicles move really weird, vehicles completely broken
 
@@ -75,6 +84,13 @@ typedef struct PlayerSyncPlayerData
   VECTOR LastReceivedPosition;
   VECTOR LastLocalPosition;
   VECTOR LastLocalRotation;
+  VECTOR Velocity; // units per ms, estimated from the last two received states
+  VECTOR ExtrapolatedPosition;
+  Moby* LastReceivedGroundMoby;
+  float LastReceivedYaw;
+  float YawVelocity; // radians per ms
+  int DryTicks; // ticks spent extrapolating since the buffer ran out
+  int CombatTicks; // full rate to everyone while > 0
   int LastNetTime;
   int LastState;
   int LastStateTime;
@@ -85,14 +101,43 @@ typedef struct PlayerSyncPlayerData
   u8 CurrentStateUpdateCmdId;
   u8 CurrentSubStateId; // used to track where we're at in between ticks
   u8 StateUpdateCmdId;
+  u8 CmdSpan; // cmds covered by the last received update, remote players only
+  u8 PeerLastCmdId[GAME_MAX_PLAYERS]; // last cmd sent to each client, local players only
   PlayerSyncStateUpdateUnpacked_t StateUpdates[CMD_BUFFER_SIZE];
 } PlayerSyncPlayerData_t;
 
+typedef struct PlayerSyncStats
+{
+  int Snaps;
+  int ExtrapolatedTicks;
+  int ExtrapolationSamples;
+  float ExtrapolationErrorSum;
+  float ExtrapolationErrorMax;
+} PlayerSyncStats_t;
+
+PlayerSyncStats_t PlayerSyncStats = {0};
 
 // config reference to check options such as if the playersync config is enabled
 extern PatchConfig_t config;
 extern PatchGameConfig_t gameConfig;
 
+#ifdef DEBUG
+//--------------------------------------------------------------------------
+void playerSyncPrintStats(void)
+{
+  float avgError = 0;
+  if (PlayerSyncStats.ExtrapolationSamples)
+    avgError = PlayerSyncStats.ExtrapolationErrorSum / PlayerSyncStats.ExtrapolationSamples;
+
+  printf("playersync: %d snaps, %d extrapolated ticks, extrapolation error avg %.3f max %.3f over %d samples\n"
+    , PlayerSyncStats.Snaps
+    , PlayerSyncStats.ExtrapolatedTicks
+    , avgError
+    , PlayerSyncStats.ExtrapolationErrorMax
+    , PlayerSyncStats.ExtrapolationSamples);
+}
+#endif
+
 //--------------------------------------------------------------------------
 int playerSyncCmdDelta(int fromCmdId, int toCmdId)
 {
@@ -132,6 +177,12 @@ int playerSyncShouldImmediatelySendStateChange(int fromState, int toState)
 {
   if (toState == PLAYER_STATE_GET_HIT) return 1;
 
+  // death and respawn
+  if (playerStateIsDead(fromState) != playerStateIsDead(toState)) return 1;
+
+  // vehicle enter/exit
+  if ((fromState == PLAYER_STATE_VEHICLE || fromState == PLAYER_STATE_TURRET_DRIVER) != (toState == PLAYER_STATE_VEHICLE || toState == PLAYER_STATE_TURRET_DRIVER)) return 1;
+
   return 0;
 }
 
@@ -234,6 +285,34 @@ void playerStateUpdateLerp(PlayerSyncStateUpdateUnpacked_t* out, PlayerSyncState
   }
 }
 
+//--------------------------------------------------------------------------
+void playerSyncExtrapolate(Player* player, PlayerSyncPlayerData_t* data, PlayerSyncStateUpdateUnpacked_t* state, VECTOR position)
+{
+  VECTOR delta;
+
+  // don't dead-reckon corpses or players riding mobies
+  // the ground moby already carries them
+  if (state->GroundMoby || playerStateIsDead(state->State)) {
+    data->DryTicks = 0;
+    return;
+  }
+
+  data->DryTicks += 1;
+  PlayerSyncStats.ExtrapolatedTicks += 1;
+
+  float ms = minf(data->DryTicks * (TIME_SECOND / GAME_FPS), EXTRAPOLATE_MAX_MS);
+  vector_scale(delta, data->Velocity, ms);
+
+  // keep grounded players on the ground
+  // vertical velocity is only meaningful while airborne
+  if (player->ground.onGood)
+    delta[2] = 0;
+
+  vector_add(position, position, delta);
+  state->Rotation[2] = clampAngle(state->Rotation[2] + (data->YawVelocity * ms));
+  vector_copy(data->ExtrapolatedPosition, position);
+}
+
 //--------------------------------------------------------------------------
 void playerSyncHandlePlayerState(Player* player)
 {
@@ -256,12 +335,14 @@ void playerSyncHandlePlayerState(Player* player)
   }
 
   // we're running behind ()
+  // the sender may be skipping cmds for us, so allow as many as the last update covered
+  int span = data->CmdSpan ? data->CmdSpan : 1;
   int stateIdDelta = playerSyncCmdDelta(data->CurrentStateUpdateCmdId, data->StateUpdateCmdId);
-  if (stateIdDelta > 1) {
+  if (stateIdDelta > span) {
     //DPRINTF("%d running behind %d, %d=>%d\n", gameGetTime(), stateIdDelta, data->CurrentStateUpdateCmdId, data->StateUpdateCmdId);
     data->CurrentSubStateId = 0;
 
-    int targetId = playerSyncGetCmdId(data->StateUpdateCmdId - 1);
+    int targetId = playerSyncGetCmdId(data->StateUpdateCmdId - span);
     while (data->CurrentStateUpdateCmdId != targetId) {
       data->StateUpdates[playerSyncCmdGetBufIndex(data->CurrentStateUpdateCmdId)].Valid = 0; // mark invalid/used
       data->CurrentStateUpdateCmdId = playerSyncGetCmdId(data->CurrentStateUpdateCmdId + 1);
@@ -313,6 +394,13 @@ void playerSyncHandlePlayerState(Player* player)
     vector_add(stateCurrentPosition, stateCurrentPosition, stateInterpolated.GroundMoby->position);
   }
 
+  // buffer ran dry, project forward from the last known velocity
+  // once new data arrives the position lerp below blends back to it
+  if (!stateNext->Valid) {
+    playerSyncExtrapolate(player, data, &stateInterpolated, stateCurrentPosition);
+  } else {
+    data->DryTicks = 0;
+  }
 
   // snap position if lerp distance is too much (i.e using teleport pads)
   float snapRadius = (stateInterpolated.GroundMoby != player->ground.pMoby) ? 24 : 49;
@@ -322,6 +410,7 @@ void playerSyncHandlePlayerState(Player* player)
     vector_subtract(dif, stateCurrentPosition, player->playerPosition);
     vector_copy(player->playerPosition, stateCurrentPosition);
     vector_add(player->fps.cameraPos, player->fps.cameraPos, dif);
+    PlayerSyncStats.Snaps += 1;
     //vector_copy(stateInterpolated.Position, data->LastReceivedPosition); //commented out in dl prod
     DPRINTF("tp player %d (dist %d) snap radius %d\n", player->fps.vars.camSettingsIndex, (int)(1000*vector_length(dt)), (int)(1000*snapRadius));
   }
@@ -388,7 +477,7 @@ void playerSyncHandlePlayerState(Player* player)
   float moveX = (stateInterpolated.MoveX - 127) / 128.0;
   float moveY = (stateInterpolated.MoveY - 127) / 128.0;
   float mag = minf(1, sqrtf((moveX*moveX) + (moveY*moveY)));
-  float ang = atan2f(moveY, moveX);
+  float ang = fastAtan2f(moveY, moveX);
 
   player->stickStrength = mag; // stickStrength
   player->stickRawAngle = ang; // stickRawAngle
@@ -617,9 +706,36 @@ int playerSyncOnReceivePlayerState(void* connection, void* data)
       nextId = playerSyncGetCmdId(nextId + 1);
     }
 
+    // estimate velocity from the last two received states
+    // only when both are in world space
+    int netDt = unpacked.GameTime - pSyncData->LastNetTime;
+    if (netDt > 0 && netDt < VELOCITY_MAX_DT_MS && !unpacked.GroundMoby && !pSyncData->LastReceivedGroundMoby) {
+      vector_subtract(pSyncData->Velocity, unpacked.Position, pSyncData->LastReceivedPosition);
+      vector_scale(pSyncData->Velocity, pSyncData->Velocity, 1.0f / netDt);
+      pSyncData->YawVelocity = clampAngle(unpacked.Rotation[2] - pSyncData->LastReceivedYaw) / netDt;
+    } else {
+      vector_write(pSyncData->Velocity, 0);
+      pSyncData->YawVelocity = 0;
+    }
+
+    // measure how far off our extrapolation was
+    if (pSyncData->DryTicks > 0 && !unpacked.GroundMoby) {
+      VECTOR err;
+      vector_subtract(err, unpacked.Position, pSyncData->ExtrapolatedPosition);
+      float errLen = vector_length(err);
+      PlayerSyncStats.ExtrapolationSamples += 1;
+      PlayerSyncStats.ExtrapolationErrorSum += errLen;
+      if (errLen > PlayerSyncStats.ExtrapolationErrorMax)
+        PlayerSyncStats.ExtrapolationErrorMax = errLen;
+      pSyncData->DryTicks = 0;
+    }
+
     pSyncData->LastNetTime = unpacked.GameTime;
+    pSyncData->CmdSpan = (u8)minf(cmdDt, PEER_MAX_INTERVAL);
     pSyncData->StateUpdateCmdId = unpacked.CmdId;
     pSyncData->TicksSinceLastUpdate = 0;
+    pSyncData->LastReceivedGroundMoby = unpacked.GroundMoby;
+    pSyncData->LastReceivedYaw = unpacked.Rotation[2];
     vector_copy(pSyncData->LastReceivedPosition, unpacked.Position);
   }
 
@@ -628,6 +744,95 @@ int playerSyncOnReceivePlayerState(void* connection, void* data)
 
 }
 
+//--------------------------------------------------------------------------
+int playerSyncGetPeerInterval(Player* player, PlayerSyncPlayerData_t* data, int clientIdx)
+{
+  VECTOR from, to, dt;
+  int i;
+  int interval = PEER_MAX_INTERVAL;
+  Player** players = playerGetAll();
+
+  if (data->CombatTicks > 0) return 1;
+
+  vector_copy(from, player->playerPosition);
+  from[2] += 1;
+
+  // take the most interested of the client's players
+  for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
+    Player* other = players[i];
+    if (!other || other->isLocal || !other->pNetPlayer || other->pNetPlayer->netClientIndex != clientIdx) continue;
+
+    vector_subtract(dt, other->playerPosition, player->playerPosition);
+    float sqrDist = vector_sqrmag(dt);
+    if (sqrDist < (PEER_NEAR_DIST * PEER_NEAR_DIST)) return 1;
+
+    int otherInterval = (sqrDist < (PEER_FAR_DIST * PEER_FAR_DIST)) ? 2 : PEER_MAX_INTERVAL;
+
+    // in line of sight
+    vector_copy(to, other->playerPosition);
+    to[2] += 1;
+    if (!CollLine_Fix(from, to, 2, player->pMoby, 0))
+      otherInterval /= 2;
+
+    if (otherInterval < interval)
+      interval = otherInterval;
+  }
+
+  return interval;
+}
+
+//--------------------------------------------------------------------------
+void playerSyncSendPlayerState(void* connection, Player* player, PlayerSyncPlayerData_t* data, PlayerSyncStateUpdatePacked_t* msg, int sendAll)
+{
+  int i, j;
+  int clients[GAME_MAX_PLAYERS];
+  int due[GAME_MAX_PLAYERS];
+  int clientCount = 0, dueCount = 0;
+  int myClientIdx = gameGetMyClientId();
+  GameSettings* gs = gameGetSettings();
+
+  // unique remote clients
+  if (gs && !sendAll) {
+    for (i = 0; i < GAME_MAX_PLAYERS; ++i) {
+      int clientIdx = gs->PlayerClients[i];
+      if (clientIdx < 0 || clientIdx == myClientIdx) continue;
+      for (j = 0; j < clientCount; ++j)
+        if (clients[j] == clientIdx) break;
+      if (j == clientCount)
+        clients[clientCount++] = clientIdx;
+    }
+  }
+
+  // pick who needs this update
+  for (i = 0; i < clientCount; ++i) {
+    int clientIdx = clients[i];
+    if (clientIdx >= GAME_MAX_PLAYERS) {
+      due[dueCount++] = clientIdx;
+      continue;
+    }
+
+    int sinceLast = playerSyncCmdDelta(data->PeerLastCmdId[clientIdx], msg->CmdId);
+    if (sinceLast <= 0 || sinceLast >= playerSyncGetPeerInterval(player, data, clientIdx))
+      due[dueCount++] = clientIdx;
+  }
+
+  // everyone is due, one broadcast is cheaper
+  if (sendAll || !gs || dueCount == clientCount) {
+    for (i = 0; i < GAME_MAX_PLAYERS; ++i)
+      data->PeerLastCmdId[i] = msg->CmdId;
+
+    netBroadcastCustomAppMessage(connection, CUSTOM_MSG_PLAYER_SYNC_STATE_UPDATE, sizeof(PlayerSyncStateUpdatePacked_t), msg);
+    return;
+  }
+
+  for (i = 0; i < dueCount; ++i) {
+    if (due[i] < GAME_MAX_PLAYERS)
+      data->PeerLastCmdId[due[i]] = msg->CmdId;
+
+    netSendCustomAppMessage(connection, due[i], CUSTOM_MSG_PLAYER_SYNC_STATE_UPDATE, sizeof(PlayerSyncStateUpdatePacked_t), msg);
+  }
+}
+
 //--------------------------------------------------------------------------
 void playerSyncBroadcastPlayerState(Player* player)
 {
@@ -640,13 +845,18 @@ void playerSyncBroadcastPlayerState(Player* player)
   int rate = playerSyncGetSendRate();
   int ticker = data->SendRateTicker--;
   int playerState = player->camera->camHeroData.state;
+  int sendAll = data->LastState != playerState && playerSyncShouldImmediatelySendStateChange(data->LastState, playerState);
+
+  // recent combat keeps everyone at full rate
+  if (player->firing || playerState == PLAYER_STATE_GET_HIT)
+    data->CombatTicks = PEER_COMBAT_TICKS;
+  else if (data->CombatTicks > 0)
+    data->CombatTicks -= 1;
 
   // stall until ticker is <= 0
   // or if there's a state change that must be sent right away
-  if (ticker > 0) {
-    if (data->LastState == playerState || !playerSyncShouldImmediatelySendStateChange(data->LastState, playerState))
+  if (ticker > 0 && !sendAll)
     return;
-  }
 
   data->SendRateTicker = rate;
 
@@ -716,7 +926,7 @@ void playerSyncBroadcastPlayerState(Player* player)
   if (msg.GadgetId >= 0 && msg.GadgetId < 32)
     msg.GadgetLevel = player->GadgetBox->Gadgets[msg.GadgetId].Level;
   */ 
-  netBroadcastCustomAppMessage(connection, CUSTOM_MSG_PLAYER_SYNC_STATE_UPDATE, sizeof(msg), &msg);
+  playerSyncSendPlayerState(connection, player, data, &msg, sendAll);
 }
 
 //--------------------------------------------------------------------------
@@ -773,6 +983,7 @@ void playerSyncTick(void)
   // reset buffer
   if (!initialized && PLAYER_SYNC_DATAS_PTR) {
     memset(PLAYER_SYNC_DATAS_PTR, 0, sizeof(PlayerSyncPlayerData_t) * GAME_MAX_PLAYERS);
+    memset(&PlayerSyncStats, 0, sizeof(PlayerSyncStats));
     DPRINTF("freed the player sync datas ptr\n");
   }
 
@@ -780,7 +991,7 @@ void playerSyncTick(void)
   if (PLAYER_SYNC_DATAS_PTR == 0) {
     DPRINTF("allocated memory for the player sync datas ptr!\n");
     DPRINTF("The address of the player sync datas pts is: %p and is of size %d", PLAYER_SYNC_DATAS_PTR, sizeof(PlayerSyncPlayerData_t) * GAME_MAX_PLAYERS);
-    PLAYER_SYNC_DATAS_PTR = malloc(sizeof(PlayerSyncPlayerData_t) * GAME_MAX_PLAYERS);
+    PLAYER_SYNC_DATAS_PTR = allocTagged(ALLOC_TAG_PLAYERSYNC, sizeof(PlayerSyncPlayerData_t) * GAME_MAX_PLAYERS);
     if (PLAYER_SYNC_DATAS_PTR) {
       memset(PLAYER_SYNC_DATAS_PTR, 0, sizeof(PlayerSyncPlayerData_t) * GAME_MAX_PLAYERS);
     }
@@ -213,9 +213,11 @@ void spectate(Player * currentPlayer, Player * playerToSpectate)
         // Generate target based off distance and elevation
         VECTOR target;
         vector_copy(target, playerToSpectate->vehicle->pMoby->position);
-        target[0] -= cosf(spectateData->LastCameraZ) * distance;
-        target[1] -= sinf(spectateData->LastCameraZ) * distance;
-        target[2] += (sinf(spectateData->LastCameraY) * distance) + elevation;
+        float sinZ, cosZ;
+        fastSincosf(spectateData->LastCameraZ, &sinZ, &cosZ);
+        target[0] -= cosZ * distance;
+        target[1] -= sinZ * distance;
+        target[2] += (fastSinf(spectateData->LastCameraY) * distance) + elevation;
 
         // Interpolate camera towards target player
         vector_lerp(spectateData->LastCameraPos, spectateData->LastCameraPos, target, 1 - powf(MATH_E, -CAMERA_POSITION_SHARPNESS * MATH_DT));
@@ -239,7 +241,7 @@ void spectate(Player * currentPlayer, Player * playerToSpectate)
 
 int findNextPlayerIndex(int currentPlayerIndex, int currentSpectateIndex, int direction)
 {
-    Player ** players = playerGetAll();
+    Player ** players = playerGetRoster()->Players;
     // int teamOnly = gameConfig.customModeId == CUSTOM_MODE_SEARCH_AND_DESTROY || gameConfig.customModeId == CUSTOM_MODE_INFECTED;
     int teamOnly = 0;
 	int newIndex = currentSpectateIndex;
@@ -279,7 +281,7 @@ void Init(void)
 void runSpectate(void)
 {
 	GameSettings * gameSettings = gameGetSettings();
-	Player ** players = playerGetAll();
+	Player ** players = playerGetRoster()->Players;
 	struct PlayerSpectateData * spectateData = 0;
 	int i = 0;
 	int direction = 0;
@@ -0,0 +1,53 @@
+#ifndef SPLEEF_MESSAGES_H
+#define SPLEEF_MESSAGES_H
+
+// misc/netbusbench.c builds the box protocol on the host without the ps2sdk
+#ifdef SPLEEF_MESSAGES_HOST
+#include <stdint.h>
+typedef uint8_t u8;
+typedef uint32_t u32;
+#define TIME_SECOND                         (1000)
+#else
+#include <tamtypes.h>
+#include <libuya/time.h>
+#endif
+#include "messageid.h"
+
+#define SPLEEF_BOARD_DIMENSION              (10)
+#define SPLEEF_BOARD_LEVELS					(2)
+#define SPLEEF_BOARD_BOX_MAX                (SPLEEF_BOARD_DIMENSION * SPLEEF_BOARD_DIMENSION * SPLEEF_BOARD_LEVELS)
+#define SPLEEF_BOARD_WORDS                  ((SPLEEF_BOARD_BOX_MAX + 31) / 32)
+#define SPLEEF_BOARD_SYNC_INTERVAL          (TIME_SECOND * 2)
+
+#define SPLEEF_BOARD_TEST(board, id)        ((board)[(id) >> 5] & (1u << ((id) & 31)))
+#define SPLEEF_BOARD_SET(board, id)         ((board)[(id) >> 5] |= (1u << ((id) & 31)))
+#define SPLEEF_BOARD_CLEAR(board, id)       ((board)[(id) >> 5] &= ~(1u << ((id) & 31)))
+
+typedef struct SpleefOutcomeMessage
+{
+	char Outcome[4];
+} SpleefOutcomeMessage_t;
+
+typedef struct SpleefDestroyBoxMessage
+{
+	int RoundNumber;
+	u32 Destroyed[SPLEEF_BOARD_WORDS];
+	signed char PlayerId; // -1 when resent after a board sync, nobody is credited
+	char Padding[3];
+} SpleefDestroyBoxMessage_t;
+
+typedef struct SpleefBoardSyncMessage
+{
+	int RoundNumber;
+	u32 Checksum;
+	u32 Board[SPLEEF_BOARD_WORDS];
+} SpleefBoardSyncMessage_t;
+
+enum GameNetMessage
+{
+	CUSTOM_MSG_SET_OUTCOME = CUSTOM_MSG_ID_GAME_MODE_START,
+	CUSTOM_MSG_DESTROY_BOX,
+	CUSTOM_MSG_BOARD_SYNC
+};
+
+#endif // SPLEEF_MESSAGES_H
@@ -18,18 +18,17 @@
 #include <libuya/net.h>
 #include <libuya/uya.h>
 #include <libuya/utils.h>
+#include <libuya/moby.h>
 #include "module.h"
 #include "config.h"
 #include "messageid.h"
 #include "include/game.h"
+#include "include/messages.h"
 
 #define SPLEEF_SPAWN_MOBY                   (MOBY_ID_CRATE_RANDOM_PICKUP)
-#define SPLEEF_BOARD_DIMENSION              (10)
-#define SPLEEF_BOARD_LEVELS					(2)
 #define SPLEEF_BOARD_LEVEL_OFFSET           (40.0)
 #define SPLEEF_BOARD_BOX_SIZE               (4.0)
 #define SPLEEF_BOARD_SPAWN_RADIUS           (SPLEEF_BOARD_BOX_SIZE * ((SPLEEF_BOARD_DIMENSION + SPLEEF_BOARD_DIMENSION) / 5))
-#define SPLEEF_BOARD_BOX_MAX                (SPLEEF_BOARD_DIMENSION * SPLEEF_BOARD_DIMENSION * SPLEEF_BOARD_LEVELS)
 
 #if UYA_PAL
 int boxUpdateFunc = 0;
@@ -56,17 +55,6 @@ int Initialized = 0;
 
 SpleefState_t SpleefState;
 
-typedef struct SpleefOutcomeMessage
-{
-	char Outcome[4];
-} SpleefOutcomeMessage_t;
-
-typedef struct SpleefDestroyBoxMessage
-{
-	short BoxId;
-	char PlayerId;
-} SpleefDestroyBoxMessage_t;
-
 struct SpleefGameData
 {
 	u32 Version;
@@ -75,13 +63,22 @@ struct SpleefGameData
 	int BoxesDestroyed[GAME_MAX_PLAYERS];
 };
 
-enum GameNetMessage
-{
-	CUSTOM_MSG_SET_OUTCOME = CUSTOM_MSG_ID_GAME_MODE_START,
-	CUSTOM_MSG_DESTROY_BOX
-};
+Moby * SpleefBox[SPLEEF_BOARD_BOX_MAX];
 
-Moby * SpleefBox[SPLEEF_BOARD_DIMENSION * SPLEEF_BOARD_DIMENSION * SPLEEF_BOARD_LEVELS];
+// Boxes are hidden and reused between rounds instead of destroyed and respawned.
+MobyPool_t SpleefBoxPool;
+Moby * SpleefBoxPoolMobies[SPLEEF_BOARD_BOX_MAX];
+
+// Bit is set while the box is standing.
+u32 SpleefBoard[SPLEEF_BOARD_WORDS];
+
+// Boxes destroyed by the local player this tick, broadcast as one message.
+u32 SpleefBoardPending[SPLEEF_BOARD_WORDS];
+int SpleefBoardPendingCount = 0;
+int SpleefBoardNextSyncTicks = 0;
+
+// Boxes destroyed locally that the host still had at its last board sync.
+u32 SpleefBoardHostMissing[SPLEEF_BOARD_WORDS];
 
 // Position that boxes are spawned to.
 VECTOR StartPos = {
@@ -168,16 +165,32 @@ void setRoundOutcome(int first, int second, int third)
 	onSetRoundOutcome(message.Outcome);
 }
 
+//--------------------------------------------------------------------------
+u32 boardChecksum(u32 * board)
+{
+	return fnv1a(board, SPLEEF_BOARD_WORDS * sizeof(u32));
+}
+
+//--------------------------------------------------------------------------
+int getBoxId(Moby * moby)
+{
+	int i;
+	for (i = 0; i < SPLEEF_BOARD_BOX_MAX; ++i)
+		if (SpleefBox[i] == moby)
+			return i;
+
+	return -1;
+}
+
 //--------------------------------------------------------------------------
 void onDestroyBox(int id, int playerId)
 {
 	Moby* box = SpleefBox[id];
-	if (box && box->OClass == SPLEEF_SPAWN_MOBY && !mobyIsDestroyed(box))
-	{
-		mobyDestroy(box);
-	}
+	if (box)
+		mobyPoolRelease(&SpleefBoxPool, box);
 
 	SpleefBox[id] = NULL;
+	SPLEEF_BOARD_CLEAR(SpleefBoard, id);
 
 	// 
 	if (playerId >= 0)
@@ -185,38 +198,159 @@ void onDestroyBox(int id, int playerId)
 
 	DPRINTF("box destroyed %d by %d\n", id, playerId);
 }
+
+//--------------------------------------------------------------------------
+void onDestroyBoxes(u32 * destroyed, int playerId)
+{
+	int i, j;
+
+	for (i = 0; i < SPLEEF_BOARD_WORDS; ++i)
+	{
+		// only visit boxes that are still standing locally
+		u32 word = destroyed[i] & SpleefBoard[i];
+		if (!word)
+			continue;
+
+		for (j = 0; j < 32; ++j)
+			if (word & (1 << j))
+				onDestroyBox((i * 32) + j, playerId);
+	}
+}
+
+//--------------------------------------------------------------------------
 int onDestroyBoxRemote(void * connection, void * data)
 {
 	SpleefDestroyBoxMessage_t * message = (SpleefDestroyBoxMessage_t*)data;
 
 	// if the round hasn't ended
-	if (!SpleefState.RoundEndTicks)
-		onDestroyBox(message->BoxId, message->PlayerId);
+	if (!SpleefState.RoundEndTicks && message->RoundNumber == SpleefState.RoundNumber)
+		onDestroyBoxes(message->Destroyed, message->PlayerId);
 
 	return sizeof(SpleefDestroyBoxMessage_t);
 }
+
+//--------------------------------------------------------------------------
 void destroyBox(int id, int playerId)
 {
-	SpleefDestroyBoxMessage_t message;
+	// already gone
+	if (!SPLEEF_BOARD_TEST(SpleefBoard, id))
+		return;
 
-	// send out
-	message.BoxId = id;
-	message.PlayerId = playerId;
-	netBroadcastCustomAppMessage(netGetDmeServerConnection(), CUSTOM_MSG_DESTROY_BOX, sizeof(SpleefDestroyBoxMessage_t), &message);
+	SPLEEF_BOARD_CLEAR(SpleefBoard, id);
+	SpleefBox[id] = NULL;
 
-	// 
+	// queue for this tick's broadcast
 	if (playerId >= 0)
+	{
+		SPLEEF_BOARD_SET(SpleefBoardPending, id);
+		++SpleefBoardPendingCount;
 		SpleefState.PlayerBoxesDestroyed[playerId]++;
-		
-	DPRINTF("sent destroy box %d\n", id);
+	}
+
+	DPRINTF("queued destroy box %d\n", id);
+}
+
+//--------------------------------------------------------------------------
+void flushDestroyedBoxes(void)
+{
+	SpleefDestroyBoxMessage_t message;
+	Player * localPlayer = playerGetFromSlot(0);
+
+	if (!SpleefBoardPendingCount)
+		return;
+
+	// send every box the local player destroyed this tick in one message
+	message.RoundNumber = SpleefState.RoundNumber;
+	message.PlayerId = localPlayer->mpIndex;
+	memcpy(message.Destroyed, SpleefBoardPending, sizeof(message.Destroyed));
+	netBroadcastCustomAppMessage(netGetDmeServerConnection(), CUSTOM_MSG_DESTROY_BOX, sizeof(SpleefDestroyBoxMessage_t), &message);
+
+	DPRINTF("sent %d destroyed boxes\n", SpleefBoardPendingCount);
+	memset(SpleefBoardPending, 0, sizeof(SpleefBoardPending));
+	SpleefBoardPendingCount = 0;
+}
+
+//--------------------------------------------------------------------------
+int onBoardSyncRemote(void * connection, void * data)
+{
+	SpleefBoardSyncMessage_t * message = (SpleefBoardSyncMessage_t*)data;
+	SpleefDestroyBoxMessage_t resend;
+	u32 hostDestroyed[SPLEEF_BOARD_WORDS];
+	u32 missing = 0;
+	int i;
+
+	// ignore stale rounds
+	if (SpleefState.RoundEndTicks || message->RoundNumber != SpleefState.RoundNumber)
+		return sizeof(SpleefBoardSyncMessage_t);
+
+	// boards agree
+	if (message->Checksum == boardChecksum(SpleefBoard))
+		return sizeof(SpleefBoardSyncMessage_t);
+
+	// boxes never come back mid round, so the boards differ both ways
+	// boxes we destroyed that the host still has at two syncs running
+	// were lost on the way to it, the rest may still be in flight
+	DPRINTF("board checksum mismatch, resyncing\n");
+	memset(&resend, 0, sizeof(resend));
+	for (i = 0; i < SPLEEF_BOARD_WORDS; ++i)
+	{
+		u32 hostMissing = message->Board[i] & ~SpleefBoard[i];
+		hostDestroyed[i] = ~message->Board[i];
+		resend.Destroyed[i] = hostMissing & SpleefBoardHostMissing[i];
+		SpleefBoardHostMissing[i] = hostMissing & ~resend.Destroyed[i];
+		missing |= resend.Destroyed[i];
+	}
+
+	// destroy whatever the host no longer has
+	onDestroyBoxes(hostDestroyed, -1);
+
+	// and send back the rest, everyone applies it before the host's next sync
+	// nobody is credited since we don't know who broke them
+	if (missing)
+	{
+		resend.RoundNumber = SpleefState.RoundNumber;
+		resend.PlayerId = -1;
+		netBroadcastCustomAppMessage(netGetDmeServerConnection(), CUSTOM_MSG_DESTROY_BOX, sizeof(SpleefDestroyBoxMessage_t), &resend);
+	}
+
+	return sizeof(SpleefBoardSyncMessage_t);
+}
+
+//--------------------------------------------------------------------------
+void sendBoardSync(void)
+{
+	SpleefBoardSyncMessage_t message;
+	int gameTime = gameGetTime();
+
+	if (!SpleefState.IsHost || gameTime < SpleefBoardNextSyncTicks)
+		return;
+
+	message.RoundNumber = SpleefState.RoundNumber;
+	message.Checksum = boardChecksum(SpleefBoard);
+	memcpy(message.Board, SpleefBoard, sizeof(message.Board));
+	netBroadcastCustomAppMessage(netGetDmeServerConnection(), CUSTOM_MSG_BOARD_SYNC, sizeof(SpleefBoardSyncMessage_t), &message);
+
+	SpleefBoardNextSyncTicks = gameTime + SPLEEF_BOARD_SYNC_INTERVAL;
 }
 
 //--------------------------------------------------------------------------
 void boxUpdate(Moby * moby)
 {
+	Player * localPlayer = playerGetFromSlot(0);
 	MobyColDamage * colDamage = mobyGetDamage(moby, 0xfffffff, 0);
-	if (moby->State == 2)
-		mobyDestroy(moby);
+	if (moby->state == 2)
+	{
+		// only the player that broke the box reports it
+		int boxId = getBoxId(moby);
+		if (boxId >= 0)
+			destroyBox(boxId, (colDamage && colDamage->Damager == localPlayer->pMoby) ? localPlayer->mpIndex : -1);
+
+		// let the crate play its break effect, then hide it
+		// the pool hands it back out next round and resetRoundState resets its state
+		((void (*)(Moby*))boxUpdateFunc)(moby);
+		mobyPoolRelease(&SpleefBoxPool, moby);
+		return;
+	}
 
 	((void (*)(Moby*))boxUpdateFunc)(moby);
 }
@@ -276,6 +410,12 @@ void resetRoundState(void)
 	SpleefState.RoundResult[2] = -1;
 	SpleefState.RoundResult[3] = -1;
 
+	// drop anything queued from the last round
+	memset(SpleefBoardPending, 0, sizeof(SpleefBoardPending));
+	memset(SpleefBoardHostMissing, 0, sizeof(SpleefBoardHostMissing));
+	SpleefBoardPendingCount = 0;
+	SpleefBoardNextSyncTicks = gameTime + SPLEEF_BOARD_SYNC_INTERVAL;
+
     // Center
 	center[0] = StartPos[0] + (SPLEEF_BOARD_BOX_SIZE * (SPLEEF_BOARD_DIMENSION / (float)2.0));
 	center[1] = StartPos[1] + (SPLEEF_BOARD_BOX_SIZE * (SPLEEF_BOARD_DIMENSION / (float)2.0));
@@ -297,24 +437,26 @@ void resetRoundState(void)
 			for (j = 0; j < SPLEEF_BOARD_DIMENSION; ++j) {
 				// delete old one
 				int boxId = (k * SPLEEF_BOARD_DIMENSION * SPLEEF_BOARD_DIMENSION) + (i * SPLEEF_BOARD_DIMENSION) + j;
-				if (!SpleefBox[boxId] || SpleefBox[boxId]->OClass != SPLEEF_SPAWN_MOBY || mobyIsDestroyed(SpleefBox[boxId]))
+				SPLEEF_BOARD_SET(SpleefBoard, boxId);
+				if (!SpleefBox[boxId] || SpleefBox[boxId]->oClass != SPLEEF_SPAWN_MOBY || mobyIsDestroyed(SpleefBox[boxId]))
 				{
-					// spawn
-					SpleefBox[boxId] = hbMoby = mobySpawn(SPLEEF_SPAWN_MOBY, 0);
+					// return the dead box to the pool and take a fresh one
+					if (SpleefBox[boxId])
+						mobyPoolRelease(&SpleefBoxPool, SpleefBox[boxId]);
+					SpleefBox[boxId] = hbMoby = mobyPoolAcquire(&SpleefBoxPool, pos);
 
 					if (hbMoby)
 					{
-						vector_copy(hbMoby->Position, pos);
-
-						hbMoby->UpdateDist = 0xFF;
-						hbMoby->Drawn = 0x01;
-						hbMoby->DrawDist = 0x0080;
-						hbMoby->Opacity = 0x80;
-						hbMoby->State = 1;
-						hbMoby->Scale = (float)0.0418 * SPLEEF_BOARD_BOX_SIZE;
-						// hbMoby->Lights = 0x202;
-						// hbMoby->GuberMoby = 0;
-						hbMoby->PUpdate = &boxUpdate;
+						hbMoby->updateDist = 0xFF;
+						hbMoby->drawn = 0x01;
+						hbMoby->drawDist = 0x0080;
+						hbMoby->alpha = 0x80;
+						hbMoby->standardDeathCalled = 0;
+						mobySetState(hbMoby, 1, -1);
+						hbMoby->scale = (float)0.0418 * SPLEEF_BOARD_BOX_SIZE;
+						// hbMoby->lights = 0x202;
+						// hbMoby->guberMoby = 0;
+						hbMoby->pUpdate = &boxUpdate;
 						++count;
 					}
 				}
@@ -342,7 +484,7 @@ void resetRoundState(void)
 	// 
 #if DEBUG
 	if (hbMoby)
-		hbMoby->Opacity = 0xFF;
+		hbMoby->alpha = 0xFF;
 	printf("Round %d started\n", SpleefState.RoundNumber);
 #endif
 }
@@ -369,9 +511,16 @@ void initialize(PatchGameConfig_t* gameConfig, PatchStateContainer_t* gameState)
 	// Hook set outcome net event
 	netInstallCustomMsgHandler(CUSTOM_MSG_SET_OUTCOME, &onSetRoundOutcomeRemote);
 	netInstallCustomMsgHandler(CUSTOM_MSG_DESTROY_BOX, &onDestroyBoxRemote);
+	netInstallCustomMsgHandler(CUSTOM_MSG_BOARD_SYNC, &onBoardSyncRemote);
 
 	// clear spleefbox array
 	memset(SpleefBox, 0, sizeof(SpleefBox));
+	memset(SpleefBoard, 0, sizeof(SpleefBoard));
+
+	// spawn every box once, rounds only hide and show them
+	mobyPoolInit(&SpleefBoxPool, SpleefBoxPoolMobies, SPLEEF_BOARD_BOX_MAX, SPLEEF_SPAWN_MOBY, 0);
+	mobyPoolReserve(&SpleefBoxPool, SPLEEF_BOARD_BOX_MAX);
+
 	memset(&SpleefState, 0, sizeof(SpleefState));
 
 	// Initialize scoreboard
@@ -474,6 +623,10 @@ void gameStart(struct GameModule * module, PatchConfig_t * config, PatchGameConf
 		}
 		else
 		{
+			// batch this tick's destroyed boxes and keep boards in sync
+			flushDestroyedBoxes();
+			sendBoardSync();
+
 			// iterate each player
 			for (i = 0; i < GAME_MAX_PLAYERS; ++i)
 				SpleefState.PlayerKills[i] = gameData->PlayerStats.DeathMatch[i].Kills;